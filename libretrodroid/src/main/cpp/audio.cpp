@@ -15,47 +15,59 @@
  *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#ifdef HOST_BUILD
+#include "tests/log_host.h"
+#else
 #include "log.h"
+#endif
 
 #include "audio.h"
+#include <algorithm>
 #include <cmath>
 #include <memory>
+#include <thread>
 
 namespace libretrodroid {
 
-Audio::Audio(int32_t sampleRate, double refreshRate, bool preferLowLatencyAudio) {
+Audio::Audio(int32_t sampleRate, double refreshRate, bool preferLowLatencyAudio, AudioTelemetry& telemetry)
+    : telemetry(telemetry) {
     LOGI("Audio initialization has been called with input sample rate %d", sampleRate);
 
     contentRefreshRate = refreshRate;
     inputSampleRate = sampleRate;
     audioLatencySettings = findBestLatencySettings(preferLowLatencyAudio);
+
+    // The ring outlives the stream: a restart after a disconnect only reopens the stream, while
+    // the emulation thread may be writing.
+    audioRing = std::make_unique<AudioRing>(computeAudioBufferSize() / 2);
+    // A callback never reads more than the ring holds, whatever the playback speed.
+    polyphaseResampler.reserve((int32_t) audioRing->getCapacityFrames());
+
     initializeStream();
 }
 
 bool Audio::initializeStream() {
     LOGI("Using low latency stream: %d", audioLatencySettings->useLowLatencyStream);
 
-    int32_t audioBufferSize = computeAudioBufferSize();
-
     oboe::AudioStreamBuilder builder;
     builder.setChannelCount(2);
     builder.setDirection(oboe::Direction::Output);
-    builder.setFormat(oboe::AudioFormat::I16);
+    builder.setFormat(findBestOutputFormat());
     builder.setDataCallback(this);
     builder.setErrorCallback(this);
 
+    // Resamplers stream across callbacks, so the burst size is left to the device.
     if (audioLatencySettings->useLowLatencyStream) {
         builder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
-    } else {
-        builder.setFramesPerCallback(audioBufferSize / 10);
     }
 
     oboe::Result result = builder.openManagedStream(stream);
     if (result == oboe::Result::OK) {
         baseConversionFactor = (double) inputSampleRate / stream->getSampleRate();
-        fifoBuffer = std::make_unique<oboe::FifoBuffer>(2, audioBufferSize);
-        temporaryAudioBuffer = std::unique_ptr<int16_t[]>(new int16_t[audioBufferSize]);
+        floatOutput = stream->getFormat() == oboe::AudioFormat::Float;
+        LOGI("Using float output: %d", floatOutput.load());
         latencyTuner = std::make_unique<oboe::LatencyTuner>(*stream);
+        telemetry.onStreamOpened(stream->getFramesPerBurst());
         return true;
     } else {
         LOGE("Failed to create stream. Error: %s", oboe::convertToText(result));
@@ -73,6 +85,16 @@ std::unique_ptr<Audio::AudioLatencySettings> Audio::findBestLatencySettings(bool
     }
 }
 
+// AAudio mixes in float, so handing it float data saves a conversion in the HAL and keeps the
+// resampler output at full precision. The legacy path is left on int16.
+oboe::AudioFormat Audio::findBestOutputFormat() {
+    if (oboe::AudioStreamBuilder::isAAudioRecommended()) {
+        return oboe::AudioFormat::Float;
+    } else {
+        return oboe::AudioFormat::I16;
+    }
+}
+
 int32_t Audio::computeAudioBufferSize() {
     double maxLatency = computeMaximumLatency();
     LOGI("Average audio latency set to: %f ms", maxLatency * 0.5);
@@ -98,15 +120,84 @@ void Audio::stop() {
 }
 
 void Audio::write(const int16_t *data, size_t frames) {
-    fifoBuffer->write(data, frames * 2);
+    bool blocking = audioSync && startRequested && stream != nullptr;
+    size_t written = blocking ? writeBlocking(data, frames) : audioRing->write(data, frames);
+    if (written < frames) {
+        telemetry.recordOverrun(frames - written);
+    }
+}
+
+// The ring is kept at half capacity, which is where the rate controller would keep it, so
+// latency does not change when switching modes.
+size_t Audio::writeBlocking(const int16_t *data, size_t frames) {
+    size_t targetFrames = std::max<size_t>(audioRing->getCapacityFrames() / 2, 1);
+    auto deadline = std::chrono::steady_clock::now() + AUDIO_SYNC_MAX_WAIT;
+
+    size_t written = 0;
+    while (written < frames) {
+        size_t available = audioRing->getFramesAvailable();
+        if (available < targetFrames) {
+            size_t chunk = std::min(frames - written, targetFrames - available);
+            written += audioRing->write(data + written * 2, chunk);
+            continue;
+        }
+
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return written + audioRing->write(data + written * 2, frames - written);
+        }
+
+        // Roughly the time the callback needs to consume what is still pending.
+        double framesPerSecond = inputSampleRate * playbackSpeed;
+        auto wait = std::chrono::duration<double>((frames - written) / framesPerSecond);
+        std::this_thread::sleep_for(std::clamp(
+            std::chrono::duration_cast<std::chrono::microseconds>(wait),
+            std::chrono::microseconds(500),
+            std::chrono::microseconds(4000)
+        ));
+    }
+    return written;
 }
 
 void Audio::setPlaybackSpeed(const double newPlaybackSpeed) {
     playbackSpeed = newPlaybackSpeed;
 }
 
+void Audio::setResamplerType(ResamplerType type) {
+    resamplerType = type;
+}
+
+void Audio::setSilenced(bool enabled) {
+    silenced = enabled;
+}
+
+void Audio::setInputSampleRate(int32_t sampleRate) {
+    inputSampleRate = sampleRate;
+    if (stream != nullptr) {
+        baseConversionFactor = (double) inputSampleRate / stream->getSampleRate();
+    }
+}
+
+void Audio::setAudioSync(bool enabled) {
+    audioSync = enabled;
+}
+
+float Audio::getFillLevel() const {
+    return (float) audioRing->getFramesAvailable() / audioRing->getCapacityFrames();
+}
+
+AudioRing::Stats Audio::getBufferStats() const {
+    return audioRing->getStats();
+}
+
 oboe::DataCallbackResult Audio::onAudioReady(oboe::AudioStream *oboeStream, void *audioData, int32_t numFrames) {
-    double dynamicBufferFactor = computeDynamicBufferConversionFactor(0.001 * numFrames);
+    if (silenced) {
+        fillSilence(audioData, 0, numFrames);
+        return oboe::DataCallbackResult::Continue;
+    }
+
+    telemetry.recordCallback(numFrames, (float) audioRing->getFramesAvailable() / audioRing->getCapacityFrames());
+
+    double dynamicBufferFactor = audioSync ? 1.0 : computeDynamicBufferConversionFactor(0.001 * numFrames);
     double finalConversionFactor = baseConversionFactor * dynamicBufferFactor * playbackSpeed;
 
     // When using low-latency stream, numFrames is very low (~100) and the dynamic buffer scaling doesn't work with rounding.
@@ -115,21 +206,69 @@ oboe::DataCallbackResult Audio::onAudioReady(oboe::AudioStream *oboeStream, void
     int32_t currentFramesToSubmit = std::round(framesToSubmit);
     framesToSubmit -= currentFramesToSubmit;
 
-    fifoBuffer->readNow(temporaryAudioBuffer.get(), currentFramesToSubmit * 2);
+    Resampler& resampler = resamplerType == ResamplerType::POLYPHASE_SINC
+        ? static_cast<Resampler&>(polyphaseResampler)
+        : static_cast<Resampler&>(linearResampler);
+
+    // Input is resampled in place from the ring. On underrun the available frames keep their
+    // share of the output and the rest is filled with silence.
+    AudioRing::Segments segments = audioRing->beginRead(currentFramesToSubmit);
+    auto availableFrames = (int32_t) segments.frames();
+    int32_t outputFrames = numFrames;
+    if (availableFrames < currentFramesToSubmit) {
+        telemetry.recordUnderrun(currentFramesToSubmit - availableFrames);
+        outputFrames = (int32_t) ((int64_t) numFrames * availableFrames / currentFramesToSubmit);
+    }
 
-    auto outputArray = reinterpret_cast<int16_t *>(audioData);
-    resampler.resample(temporaryAudioBuffer.get(), currentFramesToSubmit, outputArray, numFrames);
+    if (outputFrames > 0) {
+        if (floatOutput) {
+            resampler.resample(
+                segments.first,
+                (int32_t) segments.firstFrames,
+                segments.second,
+                (int32_t) segments.secondFrames,
+                reinterpret_cast<float *>(audioData),
+                outputFrames
+            );
+        } else {
+            resampler.resample(
+                segments.first,
+                (int32_t) segments.firstFrames,
+                segments.second,
+                (int32_t) segments.secondFrames,
+                reinterpret_cast<int16_t *>(audioData),
+                outputFrames
+            );
+        }
+        audioRing->endRead(availableFrames);
+    }
+    fillSilence(audioData, outputFrames, numFrames);
 
     latencyTuner->tune();
 
+    auto xRunCount = oboeStream->getXRunCount();
+    if (xRunCount) {
+        telemetry.recordXRunCount(xRunCount.value());
+    }
+
     return oboe::DataCallbackResult::Continue;
 }
 
+void Audio::fillSilence(void *audioData, int32_t fromFrame, int32_t toFrame) const {
+    if (floatOutput) {
+        auto outputArray = reinterpret_cast<float *>(audioData);
+        std::fill(outputArray + fromFrame * 2, outputArray + toFrame * 2, 0.0f);
+    } else {
+        auto outputArray = reinterpret_cast<int16_t *>(audioData);
+        std::fill(outputArray + fromFrame * 2, outputArray + toFrame * 2, 0);
+    }
+}
+
 // To prevent audio buffer overruns or underruns we set up a PI controller. The idea is to run the
 // audio slower when the buffer is empty and faster when it's full.
 double Audio::computeDynamicBufferConversionFactor(double dt) {
-    double framesCapacityInBuffer = fifoBuffer->getBufferCapacityInFrames();
-    double framesAvailableInBuffer = fifoBuffer->getFullFramesAvailable();
+    double framesCapacityInBuffer = audioRing->getCapacityFrames();
+    double framesAvailableInBuffer = audioRing->getFramesAvailable();
 
     // Error is represented by normalized distance to half buffer utilization. Range [-1.0, 1.0]
     double errorMeasure = (framesCapacityInBuffer - 2.0f * framesAvailableInBuffer) / framesCapacityInBuffer;
@@ -147,6 +286,7 @@ double Audio::computeDynamicBufferConversionFactor(double dt) {
     double finalAdjustment = proportionalAdjustment + integralAdjustment;
 
     LOGD("Audio speed adjustments (p: %f) (i: %f)", proportionalAdjustment, integralAdjustment);
+    telemetry.recordController(errorMeasure, proportionalAdjustment, integralAdjustment);
 
     return 1.0 - (finalAdjustment);
 }
@@ -19,11 +19,15 @@
 #define LIBRETRODROID_AUDIO_H
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <unistd.h>
 #include <oboe/Oboe.h>
-#include <oboe/FifoBuffer.h>
 
 #include "resamplers/linearresampler.h"
+#include "resamplers/polyphaseresampler.h"
+#include "utils/audioring.h"
+#include "audiotelemetry.h"
 
 namespace libretrodroid {
 
@@ -38,7 +42,12 @@ private:
     const AudioLatencySettings LOW_LATENCY_SETTINGS { 4, true };
 
 public:
-    Audio(int32_t sampleRate, double refreshRate, bool preferLowLatencyAudio);
+    enum class ResamplerType {
+        LINEAR = 0,
+        POLYPHASE_SINC = 1,
+    };
+
+    Audio(int32_t sampleRate, double refreshRate, bool preferLowLatencyAudio, AudioTelemetry& telemetry);
     ~Audio() override = default;
 
     void start();
@@ -55,12 +64,29 @@ public:
 public:
     void write(const int16_t *data, size_t frames);
     void setPlaybackSpeed(const double newPlaybackSpeed);
+    void setResamplerType(ResamplerType type);
+
+    // Outputs silence without touching the buffer or the resampler.
+    void setSilenced(bool enabled);
+    void setInputSampleRate(int32_t sampleRate);
+
+    // In audio sync mode the rate controller is bypassed and write blocks until the buffer
+    // drops to its target fill, so the emulation runs exactly at the output clock.
+    void setAudioSync(bool enabled);
+    float getFillLevel() const;
+    AudioRing::Stats getBufferStats() const;
+
+    // Whether the stream was opened in float, which is decided by the device.
+    bool isFloatOutput() const { return floatOutput; }
 
 private:
     static int32_t roundToEven(int32_t x);
     double computeDynamicBufferConversionFactor(double dt);
+    size_t writeBlocking(const int16_t *data, size_t frames);
     int32_t computeAudioBufferSize();
     bool initializeStream();
+    static oboe::AudioFormat findBestOutputFormat();
+    void fillSilence(void *audioData, int32_t fromFrame, int32_t toFrame) const;
     std::unique_ptr<Audio::AudioLatencySettings> findBestLatencySettings(bool preferLowLatencyAudio);
     double computeMaximumLatency() const;
 
@@ -70,9 +96,18 @@ private:
     const double maxp = 0.003;
     const double maxi = 0.02;
 
-    LinearResampler resampler;
-    std::unique_ptr<oboe::FifoBuffer> fifoBuffer = nullptr;
-    std::unique_ptr<int16_t[]> temporaryAudioBuffer = nullptr;
+    // Upper bound for a blocking write, in case the stream stopped consuming.
+    static constexpr std::chrono::milliseconds AUDIO_SYNC_MAX_WAIT { 50 };
+
+    // Both are kept so the audio thread can switch without allocating.
+    LinearResampler linearResampler;
+    PolyphaseResampler polyphaseResampler;
+    std::atomic<ResamplerType> resamplerType { ResamplerType::LINEAR };
+    std::atomic<bool> audioSync { false };
+    std::atomic<bool> silenced { false };
+    std::atomic<bool> floatOutput { false };
+    std::unique_ptr<AudioRing> audioRing = nullptr;
+    AudioTelemetry& telemetry;
 
     oboe::ManagedStream stream = nullptr;
     std::unique_ptr<oboe::LatencyTuner> latencyTuner = nullptr;
@@ -81,7 +116,7 @@ private:
     int32_t inputSampleRate;
     double contentRefreshRate = 60.0;
 
-    double baseConversionFactor = 1.0;
+    std::atomic<double> baseConversionFactor { 1.0 };
 
     double framesToSubmit = 0.0;
     double errorIntegral = 0.0;
@@ -0,0 +1,81 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "audiodsp.h"
+
+#include <algorithm>
+
+#include <audio/dsp_filter.h>
+#include <audio/conversion/s16_to_float.h>
+#include <audio/conversion/float_to_s16.h>
+
+#include "log.h"
+
+namespace libretrodroid {
+
+std::unique_ptr<AudioDSP> AudioDSP::create(const std::string& configPath, double sampleRate) {
+    convert_s16_to_float_init_simd();
+    convert_float_to_s16_init_simd();
+
+    retro_dsp_filter_t* filter = retro_dsp_filter_new(configPath.c_str(), nullptr, (float) sampleRate);
+    if (filter == nullptr) {
+        LOGE("Cannot load audio DSP config %s", configPath.c_str());
+        return nullptr;
+    }
+
+    LOGI("Loaded audio DSP config %s", configPath.c_str());
+    return std::unique_ptr<AudioDSP>(new AudioDSP(filter));
+}
+
+AudioDSP::AudioDSP(retro_dsp_filter* filter) :
+    filter(filter),
+    samples(MAX_BATCH_FRAMES * 2),
+    output(DEFAULT_OUTPUT_FRAMES * 2) { }
+
+AudioDSP::~AudioDSP() {
+    retro_dsp_filter_free(filter);
+}
+
+std::pair<const int16_t*, size_t> AudioDSP::process(const int16_t* data, size_t frames) {
+    size_t outputFrames = 0;
+
+    while (frames > 0) {
+        size_t batchFrames = std::min(frames, MAX_BATCH_FRAMES);
+        convert_s16_to_float(samples.data(), data, batchFrames * 2, 1.0f);
+
+        retro_dsp_data dspData {};
+        dspData.input = samples.data();
+        dspData.input_frames = (unsigned) batchFrames;
+        retro_dsp_filter_process(filter, &dspData);
+
+        // Only grows when a core hands out more audio than ever before.
+        size_t required = (outputFrames + dspData.output_frames) * 2;
+        if (output.size() < required) {
+            output.resize(required);
+        }
+
+        convert_float_to_s16(&output[outputFrames * 2], dspData.output, dspData.output_frames * 2);
+        outputFrames += dspData.output_frames;
+
+        data += batchFrames * 2;
+        frames -= batchFrames;
+    }
+
+    return { output.data(), outputFrames };
+}
+
+}
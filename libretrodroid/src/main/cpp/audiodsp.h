@@ -0,0 +1,63 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_AUDIODSP_H
+#define LIBRETRODROID_AUDIODSP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct retro_dsp_filter;
+
+namespace libretrodroid {
+
+// Float DSP stage built on libretro-common's filter chain, configured with RetroArch .dsp files.
+// Only the filters compiled in as builtins are available (eq, iir, echo, chorus, phaser, wahwah
+// and panning). Buffers are preallocated, so processing a batch does not allocate.
+class AudioDSP {
+public:
+    // Returns null when the config cannot be loaded.
+    static std::unique_ptr<AudioDSP> create(const std::string& configPath, double sampleRate);
+    ~AudioDSP();
+
+    AudioDSP(const AudioDSP&) = delete;
+    AudioDSP& operator=(const AudioDSP&) = delete;
+
+    // Returns the filtered stereo frames, valid until the next call. Block based filters may
+    // return more or fewer frames than they were given.
+    std::pair<const int16_t*, size_t> process(const int16_t* data, size_t frames);
+
+private:
+    explicit AudioDSP(retro_dsp_filter* filter);
+
+private:
+    // The eq filter can hold a block on top of its input in a 4096 frame buffer.
+    static constexpr size_t MAX_BATCH_FRAMES = 1024;
+    static constexpr size_t DEFAULT_OUTPUT_FRAMES = 8192;
+
+    retro_dsp_filter* filter;
+    std::vector<float> samples;
+    std::vector<int16_t> output;
+};
+
+}
+
+#endif //LIBRETRODROID_AUDIODSP_H
@@ -0,0 +1,156 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "audiotelemetry.h"
+
+#include <algorithm>
+
+namespace libretrodroid {
+
+void AudioTelemetry::onStreamOpened(int32_t requestedFrames) {
+    requestedCallbackFrames.store(requestedFrames, std::memory_order_relaxed);
+    lastStreamXRuns.store(0, std::memory_order_relaxed);
+}
+
+void AudioTelemetry::recordCallback(int32_t frames, float fillLevel) {
+    callbacks.fetch_add(1, std::memory_order_relaxed);
+    totalCallbackFrames.fetch_add(frames, std::memory_order_relaxed);
+    lastCallbackFrames.store(frames, std::memory_order_relaxed);
+
+    if (frames < minCallbackFrames.load(std::memory_order_relaxed)) {
+        minCallbackFrames.store(frames, std::memory_order_relaxed);
+    }
+    if (frames > maxCallbackFrames.load(std::memory_order_relaxed)) {
+        maxCallbackFrames.store(frames, std::memory_order_relaxed);
+    }
+
+    auto bucket = (size_t) (std::clamp(fillLevel, 0.0f, 1.0f) * FILL_BUCKET_COUNT);
+    bucket = std::min(bucket, FILL_BUCKET_COUNT - 1);
+    fillBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioTelemetry::recordUnderrun(size_t missingFrames) {
+    underruns.fetch_add(1, std::memory_order_relaxed);
+    underrunFrames.fetch_add(missingFrames, std::memory_order_relaxed);
+}
+
+void AudioTelemetry::recordOverrun(size_t droppedFrames) {
+    overruns.fetch_add(1, std::memory_order_relaxed);
+    overrunFrames.fetch_add(droppedFrames, std::memory_order_relaxed);
+}
+
+void AudioTelemetry::recordController(double error, double proportional, double integral) {
+    uint64_t index = controllerTraceCount.load(std::memory_order_relaxed);
+    TraceEntry& entry = controllerTrace[index % CONTROLLER_TRACE_SIZE];
+    entry.error.store((float) error, std::memory_order_relaxed);
+    entry.proportional.store((float) proportional, std::memory_order_relaxed);
+    entry.integral.store((float) integral, std::memory_order_relaxed);
+    controllerTraceCount.store(index + 1, std::memory_order_release);
+}
+
+void AudioTelemetry::recordXRunCount(int32_t streamXRuns) {
+    int32_t lastXRuns = lastStreamXRuns.exchange(streamXRuns, std::memory_order_relaxed);
+    if (streamXRuns > lastXRuns) {
+        xRuns.fetch_add(streamXRuns - lastXRuns, std::memory_order_relaxed);
+    }
+}
+
+AudioTelemetry::Snapshot AudioTelemetry::getSnapshot() const {
+    Snapshot result {};
+    result.callbacks = callbacks.load(std::memory_order_relaxed);
+    result.underruns = underruns.load(std::memory_order_relaxed);
+    result.underrunFrames = underrunFrames.load(std::memory_order_relaxed);
+    result.overruns = overruns.load(std::memory_order_relaxed);
+    result.overrunFrames = overrunFrames.load(std::memory_order_relaxed);
+    result.xRuns = xRuns.load(std::memory_order_relaxed);
+    result.requestedCallbackFrames = requestedCallbackFrames.load(std::memory_order_relaxed);
+    result.lastCallbackFrames = lastCallbackFrames.load(std::memory_order_relaxed);
+    result.maxCallbackFrames = maxCallbackFrames.load(std::memory_order_relaxed);
+    result.totalCallbackFrames = totalCallbackFrames.load(std::memory_order_relaxed);
+
+    int32_t minFrames = minCallbackFrames.load(std::memory_order_relaxed);
+    result.minCallbackFrames = minFrames == INT32_MAX ? 0 : minFrames;
+
+    std::array<uint64_t, FILL_BUCKET_COUNT> buckets {};
+    uint64_t total = 0;
+    for (size_t i = 0; i < FILL_BUCKET_COUNT; i++) {
+        buckets[i] = fillBuckets[i].load(std::memory_order_relaxed);
+        total += buckets[i];
+    }
+
+    result.fillP5 = fillPercentile(buckets, total, 0.05f);
+    result.fillP50 = fillPercentile(buckets, total, 0.50f);
+    result.fillP95 = fillPercentile(buckets, total, 0.95f);
+    return result;
+}
+
+// Returns the center of the bucket holding the percentile.
+float AudioTelemetry::fillPercentile(
+    const std::array<uint64_t, FILL_BUCKET_COUNT>& buckets,
+    uint64_t total,
+    float percentile
+) const {
+    if (total == 0) {
+        return 0.0f;
+    }
+
+    auto target = (uint64_t) (percentile * (float) total);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < FILL_BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen > target) {
+            return ((float) i + 0.5f) / FILL_BUCKET_COUNT;
+        }
+    }
+    return 1.0f;
+}
+
+size_t AudioTelemetry::getControllerTrace(ControllerSample* out, size_t capacity) const {
+    uint64_t count = controllerTraceCount.load(std::memory_order_acquire);
+    size_t available = (size_t) std::min<uint64_t>(count, CONTROLLER_TRACE_SIZE);
+    size_t result = std::min(available, capacity);
+
+    uint64_t first = count - result;
+    for (size_t i = 0; i < result; i++) {
+        const TraceEntry& entry = controllerTrace[(first + i) % CONTROLLER_TRACE_SIZE];
+        out[i].error = entry.error.load(std::memory_order_relaxed);
+        out[i].proportional = entry.proportional.load(std::memory_order_relaxed);
+        out[i].integral = entry.integral.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void AudioTelemetry::reset() {
+    callbacks.store(0, std::memory_order_relaxed);
+    underruns.store(0, std::memory_order_relaxed);
+    underrunFrames.store(0, std::memory_order_relaxed);
+    overruns.store(0, std::memory_order_relaxed);
+    overrunFrames.store(0, std::memory_order_relaxed);
+    xRuns.store(0, std::memory_order_relaxed);
+    lastCallbackFrames.store(0, std::memory_order_relaxed);
+    minCallbackFrames.store(INT32_MAX, std::memory_order_relaxed);
+    maxCallbackFrames.store(0, std::memory_order_relaxed);
+    totalCallbackFrames.store(0, std::memory_order_relaxed);
+
+    for (auto& bucket : fillBuckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+
+    controllerTraceCount.store(0, std::memory_order_release);
+}
+
+}
@@ -0,0 +1,111 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_AUDIOTELEMETRY_H
+#define LIBRETRODROID_AUDIOTELEMETRY_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace libretrodroid {
+
+// In-memory counters for the audio pipeline, meant to tune the rate controller from field data.
+// Callback related values are recorded on the audio thread, overruns on the emulation thread,
+// and everything can be read from any thread. It outlives the Audio instances so counts add up
+// across games until reset.
+class AudioTelemetry {
+public:
+    static constexpr size_t FILL_BUCKET_COUNT = 50;
+    static constexpr size_t CONTROLLER_TRACE_SIZE = 1024;
+
+    struct Snapshot {
+        uint64_t callbacks;
+        uint64_t underruns;
+        uint64_t underrunFrames;
+        uint64_t overruns;
+        uint64_t overrunFrames;
+        uint64_t xRuns;
+        int32_t requestedCallbackFrames;
+        int32_t lastCallbackFrames;
+        int32_t minCallbackFrames;
+        int32_t maxCallbackFrames;
+        uint64_t totalCallbackFrames;
+
+        // Buffer fill level percentiles over all callbacks, in [0, 1].
+        float fillP5;
+        float fillP50;
+        float fillP95;
+    };
+
+    struct ControllerSample {
+        float error;
+        float proportional;
+        float integral;
+    };
+
+    void onStreamOpened(int32_t requestedCallbackFrames);
+
+    void recordCallback(int32_t frames, float fillLevel);
+    void recordUnderrun(size_t missingFrames);
+    void recordOverrun(size_t droppedFrames);
+    void recordController(double error, double proportional, double integral);
+
+    // Takes the cumulative count reported by the current stream.
+    void recordXRunCount(int32_t streamXRuns);
+
+    Snapshot getSnapshot() const;
+
+    // Copies the most recent controller samples, oldest first, and returns how many were written.
+    size_t getControllerTrace(ControllerSample* out, size_t capacity) const;
+
+    void reset();
+
+private:
+    float fillPercentile(const std::array<uint64_t, FILL_BUCKET_COUNT>& buckets, uint64_t total, float percentile) const;
+
+private:
+    struct TraceEntry {
+        std::atomic<float> error { 0.0f };
+        std::atomic<float> proportional { 0.0f };
+        std::atomic<float> integral { 0.0f };
+    };
+
+    std::atomic<uint64_t> callbacks { 0 };
+    std::atomic<uint64_t> underruns { 0 };
+    std::atomic<uint64_t> underrunFrames { 0 };
+    std::atomic<uint64_t> overruns { 0 };
+    std::atomic<uint64_t> overrunFrames { 0 };
+    std::atomic<uint64_t> xRuns { 0 };
+    std::atomic<int32_t> lastStreamXRuns { 0 };
+
+    std::atomic<int32_t> requestedCallbackFrames { 0 };
+    std::atomic<int32_t> lastCallbackFrames { 0 };
+    std::atomic<int32_t> minCallbackFrames { INT32_MAX };
+    std::atomic<int32_t> maxCallbackFrames { 0 };
+    std::atomic<uint64_t> totalCallbackFrames { 0 };
+
+    std::array<std::atomic<uint64_t>, FILL_BUCKET_COUNT> fillBuckets {};
+
+    std::array<TraceEntry, CONTROLLER_TRACE_SIZE> controllerTrace;
+    std::atomic<uint64_t> controllerTraceCount { 0 };
+};
+
+}
+
+#endif //LIBRETRODROID_AUDIOTELEMETRY_H
@@ -80,6 +80,7 @@ void Environment::updateVariable(const std::string& key, const std::string& valu
         current.value = value;
         variables[key] = current;
         dirtyVariables = true;
+        variablesGeneration++;
     }
 }
 
@@ -480,6 +481,10 @@ const std::vector<struct Variable> Environment::getVariables() const {
     return result;
 }
 
+unsigned int Environment::getVariablesGeneration() const {
+    return variablesGeneration;
+}
+
 const std::vector<std::vector<struct Controller>> &Environment::getControllers() const {
     return controllers;
 }
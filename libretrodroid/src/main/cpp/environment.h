@@ -109,6 +109,10 @@ public:
 
     const std::vector<struct Variable> getVariables() const;
 
+    // Incremented whenever a variable value changes, lets other readers track updates without
+    // consuming GET_VARIABLE_UPDATE for the core.
+    unsigned int getVariablesGeneration() const;
+
     const std::vector<std::vector<struct Controller>> &getControllers() const;
 
     const struct retro_memory_map* getMemoryMap() const;
@@ -153,6 +157,7 @@ private:
 
     std::unordered_map<std::string, struct Variable> variables;
     bool dirtyVariables = false;
+    unsigned int variablesGeneration = 0;
 
     std::vector<std::vector<struct Controller>> controllers;
 
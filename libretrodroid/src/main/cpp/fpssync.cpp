@@ -22,7 +22,7 @@
 namespace libretrodroid {
 
 unsigned FPSSync::advanceFrames() {
-    if (useVSync) return 1;
+    if (useVSync || useAudioSync) return 1;
 
     if (lastFrame == MIN_TIME) {
         start();
@@ -53,11 +53,12 @@ void FPSSync::reset() {
 }
 
 double FPSSync::getTimeStretchFactor() {
+    if (useAudioSync) return 1.0;
     return useVSync ? contentRefreshRate / screenRefreshRate : 1.0;
 }
 
 void FPSSync::wait() {
-    if (useVSync) return;
+    if (useVSync || useAudioSync) return;
     std::this_thread::sleep_until(lastFrame);
 }
 
@@ -70,4 +71,10 @@ void FPSSync::setExternalTimingControl(bool enabled) {
     reset();
 }
 
+void FPSSync::setAudioSync(bool enabled) {
+    LOGI("Audio sync: %d", enabled);
+    useAudioSync = enabled;
+    reset();
+}
+
 } //namespace libretrodroid
@@ -36,11 +36,15 @@ public:
     void wait();
     double getTimeStretchFactor();
     void setExternalTimingControl(bool enabled);
+
+    // Leaves pacing to the audio output, which blocks the emulation thread while its buffer is full.
+    void setAudioSync(bool enabled);
 private:
 
     double screenRefreshRate;
     double contentRefreshRate;
     bool useVSync;
+    bool useAudioSync = false;
     const double FPS_TOLERANCE = 5;
 
     const TimePoint MIN_TIME = TimePoint::min();
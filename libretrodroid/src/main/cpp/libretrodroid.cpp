@@ -19,6 +19,8 @@
 
 #include <EGL/egl.h>
 
+#include <cstdio>
+#include <fstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -62,7 +64,7 @@ void LibretroDroid::callback_hw_video_refresh(
 }
 
 void LibretroDroid::callback_audio_sample(int16_t left, int16_t right) {
-    LOGE("callback audio sample (left, right) has been called");
+    LibretroDroid::getInstance().handleAudioSample(left, right);
 }
 
 size_t LibretroDroid::callback_set_audio_sample_batch(const int16_t *data, size_t frames) {
@@ -73,6 +75,10 @@ void LibretroDroid::callback_retro_set_input_poll() {
     // Do nothing in here...
 }
 
+bool LibretroDroid::callback_secondary_environment(unsigned cmd, void *data) {
+    return LibretroDroid::getInstance().handleSecondaryEnvironment(cmd, data);
+}
+
 int16_t LibretroDroid::callback_set_input_state(
     unsigned int port,
     unsigned int device,
@@ -83,8 +89,10 @@ int16_t LibretroDroid::callback_set_input_state(
 }
 
 void LibretroDroid::updateAudioSampleRateMultiplier() {
+    bool fastForwarding = frameSpeed > 1;
     if (audio) {
-        audio->setPlaybackSpeed(frameSpeed);
+        audio->setPlaybackSpeed(fastForwardAudio == FastForwardAudio::PITCH ? frameSpeed : 1);
+        audio->setSilenced(fastForwarding && fastForwardAudio == FastForwardAudio::DROP);
     }
 }
 
@@ -142,9 +150,16 @@ std::vector<std::vector<struct Controller>> LibretroDroid::getControllers() {
 
 void LibretroDroid::setControllerType(unsigned int port, unsigned int type) {
     core->retro_set_controller_port_device(port, type);
+    if (secondaryCore) {
+        secondaryCore->retro_set_controller_port_device(port, type);
+    }
 }
 
 bool LibretroDroid::unserializeState(int8_t *data, size_t size) {
+    // Saved frames belong to the previous timeline, rolling back to them would undo the load.
+    if (preemptiveFrames) {
+        preemptiveFrames->clear();
+    }
     return core->retro_unserialize(data, size);
 }
 
@@ -164,18 +179,15 @@ JNIEXPORT jboolean JNICALL LibretroDroid::unserializeSRAM(int8_t* data, size_t s
 
     memcpy(sramState, data, size);
 
-    return true;
-}
-
-std::pair<int8_t*, size_t> LibretroDroid::serializeSRAM() {
-    size_t size = core->retro_get_memory_size(RETRO_MEMORY_SAVE_RAM);
-    auto* data = new int8_t[size];
-    memcpy(data, (int8_t*) core->retro_get_memory_data(RETRO_MEMORY_SAVE_RAM), size);
+    // The loaded content is what the save file holds.
+    if (sramMonitor) {
+        sramMonitor->reset((const uint8_t*) sramState, sramSize);
+    }
 
-    return std::pair(data, size);
+    return true;
 }
 
-std::pair<int8_t*, size_t> LibretroDroid::getMemoryData(unsigned int memoryType) {
+std::pair<const int8_t*, size_t> LibretroDroid::getMemoryView(unsigned int memoryType) {
     size_t size = core->retro_get_memory_size(memoryType);
     if (size == 0) {
         return std::pair(nullptr, 0);
@@ -186,15 +198,48 @@ std::pair<int8_t*, size_t> LibretroDroid::getMemoryData(unsigned int memoryType)
         return std::pair(nullptr, 0);
     }
 
-    auto* data = new int8_t[size];
-    memcpy(data, (int8_t*) memPtr, size);
-    return std::pair(data, size);
+    return std::pair((const int8_t*) memPtr, size);
 }
 
 size_t LibretroDroid::getMemorySize(unsigned int memoryType) {
     return core->retro_get_memory_size(memoryType);
 }
 
+void LibretroDroid::startSRAMMonitor(size_t pageSize) {
+    auto [data, size] = getMemoryView(RETRO_MEMORY_SAVE_RAM);
+    if (data == nullptr) {
+        LOGI("Core does not expose save RAM, SRAM monitor not started");
+        sramMonitor = nullptr;
+        return;
+    }
+
+    sramMonitor = std::make_unique<SRAMMonitor>(pageSize);
+    sramMonitor->reset((const uint8_t*) data, size);
+}
+
+void LibretroDroid::stopSRAMMonitor() {
+    sramMonitor = nullptr;
+}
+
+std::vector<uint32_t> LibretroDroid::getSRAMDirtyPages() {
+    auto [data, size] = getMemoryView(RETRO_MEMORY_SAVE_RAM);
+    if (!sramMonitor || data == nullptr) {
+        return { };
+    }
+
+    sramMonitor->scan((const uint8_t*) data, size);
+    return sramMonitor->getDirtyPages();
+}
+
+ssize_t LibretroDroid::flushSRAM(int fd) {
+    auto [data, size] = getMemoryView(RETRO_MEMORY_SAVE_RAM);
+    if (!sramMonitor || data == nullptr) {
+        return -1;
+    }
+
+    return sramMonitor->flush(fd, (const uint8_t*) data, size);
+}
+
 void LibretroDroid::onSurfaceChanged(unsigned int width, unsigned int height) {
     LOGD("Performing libretrodroid onSurfaceChanged");
     video->updateScreenSize(width, height);
@@ -226,7 +271,8 @@ void LibretroDroid::onSurfaceCreated() {
         skipDuplicateFrames,
         immersiveModeEnabled,
         viewportRect,
-        immersiveModeConfig
+        immersiveModeConfig,
+        videoTelemetry
     );
 
     video = std::unique_ptr<Video>(newVideo);
@@ -287,7 +333,8 @@ void LibretroDroid::create(
     bool enableMicrophone,
     bool duplicateFrames,
     std::optional<ImmersiveMode::Config> immersiveModeConfig,
-    const std::string& language
+    const std::string& language,
+    const std::string& cacheDir
 ) {
     LOGD("Performing libretrodroid create");
 
@@ -305,6 +352,9 @@ void LibretroDroid::create(
     this->immersiveModeConfig = immersiveModeConfig.value_or(ImmersiveMode::Config{});
     audioEnabled = true;
     frameSpeed = 1;
+    coreFilePath = soFilePath;
+    cacheDirectory = cacheDir;
+    gameFilePath.clear();
 
     core = std::make_unique<Core>(soFilePath);
 
@@ -346,9 +396,9 @@ void LibretroDroid::loadGameFromPath(const std::string& gamePath) {
         game_info.data = nullptr;
         game_info.size = 0;
     } else {
-        struct Utils::ReadResult file = Utils::readFileAsBytes(gamePath);
-        game_info.data = file.data;
-        game_info.size = file.size;
+        gameFile = MappedFile::open(gamePath);
+        game_info.data = gameFile->data();
+        game_info.size = gameFile->size();
     }
 
     bool result = core->retro_load_game(&game_info);
@@ -357,6 +407,9 @@ void LibretroDroid::loadGameFromPath(const std::string& gamePath) {
         throw std::runtime_error("Cannot load game");
     }
 
+    // Only games loaded from a path can be loaded a second time for run-ahead.
+    gameFilePath = gamePath;
+
     afterGameLoad();
 }
 
@@ -414,9 +467,9 @@ void LibretroDroid::loadGameFromVirtualFiles(std::vector<VFSFile> virtualFiles)
         game_info.data = nullptr;
         game_info.size = 0;
     } else {
-        struct Utils::ReadResult file = Utils::readFileAsBytes(firstFileFD);
-        game_info.data = file.data;
-        game_info.size = file.size;
+        gameFile = MappedFile::open(firstFileFD);
+        game_info.data = gameFile->data();
+        game_info.size = gameFile->size();
     }
 
     bool result = core->retro_load_game(&game_info);
@@ -435,9 +488,17 @@ void LibretroDroid::destroy() {
         Environment::getInstance().getHwContextDestroy()();
     }
 
+    memoryGeneration++;
+    sramMonitor = nullptr;
+    destroySecondaryCore();
+    serializeBufferPool.clear();
+
     core->retro_unload_game();
     core->retro_deinit();
 
+    // Cores may keep pointers into the game data until they are unloaded.
+    gameFile = nullptr;
+
     video = nullptr;
     core = nullptr;
     rumble = nullptr;
@@ -468,6 +529,10 @@ void LibretroDroid::pause() {
 void LibretroDroid::step() {
     LOGD("Stepping into retro_run()");
 
+    auto stepStart = std::chrono::steady_clock::now();
+
+    updateAudioSync();
+
     unsigned frames = 1;
     if (fpsSync) {
         unsigned requestedFrames = fpsSync->advanceFrames();
@@ -476,8 +541,41 @@ void LibretroDroid::step() {
         frames = std::min(requestedFrames, 2u);
     }
 
-    for (size_t i = 0; i < frames * frameSpeed; i++)
-        core->retro_run();
+    // Presentation can be slower than the content, for instance with vsync on a 60Hz screen and
+    // 60.1fps content. The audio buffer then drains and the lost time is made up here.
+    if (audioSyncActive && audio->getFillLevel() < AUDIO_SYNC_CATCH_UP_LEVEL) {
+        frames = 2;
+    }
+
+    size_t runs = frames * frameSpeed;
+    if (preemptiveFrames) {
+        // Every frame has to be saved, so the ring always covers the last frames. When saving
+        // fails preemptive frames are disabled and the remaining frames run normally.
+        size_t i = 0;
+        for (; i < runs && preemptiveFrames; i++)
+            runFrameWithPreemptiveFrames();
+
+        for (; i < runs; i++)
+            core->retro_run();
+    } else if (runAheadFrames > 0 && !runAheadFailed) {
+        // Only the presented frame needs to look ahead.
+        for (size_t i = 0; i + 1 < runs; i++)
+            core->retro_run();
+
+        runFrameWithRunAhead();
+    } else {
+        for (size_t i = 0; i < runs; i++)
+            core->retro_run();
+    }
+
+    flushAudioSamples();
+
+    if (sramMonitor) {
+        auto [sramData, sramSize] = getMemoryView(RETRO_MEMORY_SAVE_RAM);
+        if (sramData != nullptr) {
+            sramMonitor->onFrame((const uint8_t*) sramData, sramSize);
+        }
+    }
 
     if (achievements.isActive()) {
         achievements.evaluateFrame();
@@ -487,6 +585,9 @@ void LibretroDroid::step() {
         video->renderFrame();
     }
 
+    // Time spent sleeping for frame pacing is not part of the frame cost.
+    stepTimeHistogram.record(std::chrono::steady_clock::now() - stepStart);
+
     if (fpsSync) {
         fpsSync->wait();
     }
@@ -541,10 +642,374 @@ void LibretroDroid::setFrameSpeed(unsigned int speed) {
     updateAudioSampleRateMultiplier();
 }
 
+void LibretroDroid::setFastForwardAudio(FastForwardAudio mode) {
+    fastForwardAudio = mode;
+    updateAudioSampleRateMultiplier();
+}
+
+void LibretroDroid::setRunAhead(unsigned int frames, bool useSecondInstance) {
+    runAheadFrames = frames;
+    runAheadSecondInstance = useSecondInstance;
+    runAheadFailed = false;
+
+    if (frames == 0 || !useSecondInstance) {
+        destroySecondaryCore();
+    }
+
+    // Without a game the copy starts once it is loaded.
+    if (fpsSync) {
+        prepareSecondaryCore();
+    }
+
+    if (frames > 0) {
+        preemptiveFrames = nullptr;
+    }
+}
+
+void LibretroDroid::setPreemptiveFrames(unsigned int frames) {
+    if (frames == 0) {
+        preemptiveFrames = nullptr;
+        return;
+    }
+
+    preemptiveFrames = std::make_unique<PreemptiveFrames>(frames);
+    setRunAhead(0, false);
+}
+
+// The real frame runs first with its audio but without its video. Its state is then copied and
+// runAheadFrames more frames are simulated without audio, presenting only the last one. Finally
+// the real state is restored, unless a second instance did the simulation.
+void LibretroDroid::runFrameWithRunAhead() {
+    suppressVideo = true;
+    core->retro_run();
+    suppressVideo = false;
+
+    size_t stateSize = core->retro_serialize_size();
+    if (runAheadState.size() < stateSize) {
+        runAheadState.resize(stateSize);
+    }
+
+    if (stateSize == 0 || !core->retro_serialize(runAheadState.data(), stateSize)) {
+        // The previous frame stays on screen once, then we keep running without run-ahead.
+        LOGE("Core cannot serialize its state, disabling run-ahead");
+        runAheadFailed = true;
+        return;
+    }
+
+    Core* aheadCore = getRunAheadCore();
+    if (aheadCore != core.get() && !aheadCore->retro_unserialize(runAheadState.data(), stateSize)) {
+        LOGE("Run-ahead instance rejected the state, falling back to a single instance");
+        destroySecondaryCore();
+        secondaryCoreFailed = true;
+        aheadCore = core.get();
+    }
+
+    suppressAudio = true;
+    for (unsigned i = 0; i < runAheadFrames; i++) {
+        suppressVideo = i + 1 < runAheadFrames;
+        aheadCore->retro_run();
+    }
+    suppressVideo = false;
+    suppressAudio = false;
+
+    if (aheadCore == core.get()) {
+        core->retro_unserialize(runAheadState.data(), stateSize);
+    }
+}
+
+// The core runs with the newest input as if it was pressed preemptiveFrames frames ago. As long
+// as the polled inputs don't change this is exactly what happened, otherwise the saved frames are
+// replayed silently from the oldest state before running the current one.
+void LibretroDroid::runFrameWithPreemptiveFrames() {
+    auto queryInput = [&](unsigned port, unsigned device, unsigned index, unsigned id) -> int16_t {
+        return input ? input->getInputState(port, device, index, id) : 0;
+    };
+
+    if (preemptiveFrames->isFull() && preemptiveFrames->hasInputChanged(queryInput)) {
+        unsigned replayFrames = preemptiveFrames->getFrames();
+        if (preemptiveFrames->rollback(*core)) {
+            suppressVideo = true;
+            suppressAudio = true;
+            for (unsigned i = 0; i < replayFrames; i++) {
+                preemptiveFrames->pushState(*core);
+                core->retro_run();
+            }
+            suppressVideo = false;
+            suppressAudio = false;
+        }
+    }
+
+    preemptiveFrames->clearInputs();
+
+    if (!preemptiveFrames->pushState(*core)) {
+        LOGE("Core cannot serialize its state, disabling preemptive frames");
+        preemptiveFrames = nullptr;
+    }
+
+    core->retro_run();
+}
+
+// Until the second instance is loaded, run-ahead keeps using the main one.
+Core* LibretroDroid::getRunAheadCore() {
+    if (!runAheadSecondInstance || secondaryCoreFailed) {
+        return core.get();
+    }
+
+    if (secondaryCore) {
+        return secondaryCore.get();
+    }
+
+    if (!secondaryCoreLoad.valid()) {
+        prepareSecondaryCore();
+        return core.get();
+    }
+
+    if (secondaryCoreLoad.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return core.get();
+    }
+
+    SecondaryInstance instance = secondaryCoreLoad.get();
+    if (!instance.core) {
+        LOGE("Second run-ahead instance is not available, using a single instance");
+        secondaryCoreFailed = true;
+        return core.get();
+    }
+
+    secondaryCore = std::move(instance.core);
+    secondaryGameFile = std::move(instance.gameFile);
+    secondaryVariablesGeneration = instance.variablesGeneration;
+    return secondaryCore.get();
+}
+
+// Copying the core and loading the game in it can take a while, both run once per game off the
+// GL thread. Only the finished instance is swapped in by getRunAheadCore.
+void LibretroDroid::prepareSecondaryCore() {
+    if (runAheadFrames == 0 || !runAheadSecondInstance || secondaryCore || secondaryCoreLoad.valid()) {
+        return;
+    }
+
+    // A hardware rendered instance would need its own GL context.
+    if (Environment::getInstance().isUseHwAcceleration() || gameFilePath.empty() || cacheDirectory.empty()) {
+        LOGI("Second run-ahead instance is not supported for this game, using a single instance");
+        secondaryCoreFailed = true;
+        return;
+    }
+
+    // The loading core reads this snapshot, the variables themselves belong to the GL thread. A
+    // change made meanwhile is reported through GET_VARIABLE_UPDATE once the instance is in use.
+    unsigned int variablesGeneration = Environment::getInstance().getVariablesGeneration();
+    std::vector<Variable> variables = Environment::getInstance().getVariables();
+
+    secondaryCoreLoad = std::async(
+        std::launch::async,
+        [corePath = coreFilePath, copyPath = cacheDirectory + "/runahead_core.so", gamePath = gameFilePath,
+         variables = std::move(variables), variablesGeneration]() {
+            SecondaryInstance instance = loadSecondaryCore(corePath, copyPath, gamePath, variables);
+            instance.variablesGeneration = variablesGeneration;
+            return instance;
+        }
+    );
+}
+
+// Set while a run-ahead instance loads on the current thread, see prepareSecondaryCore.
+static thread_local const std::vector<Variable>* secondaryLoadVariables = nullptr;
+
+// dlopen returns the already loaded library for the same path, so the core is copied to get its
+// own globals.
+LibretroDroid::SecondaryInstance LibretroDroid::loadSecondaryCore(
+    const std::string& corePath,
+    const std::string& copyPath,
+    const std::string& gamePath,
+    const std::vector<Variable>& variables
+) {
+    SecondaryInstance instance;
+
+    {
+        std::ifstream input(corePath, std::ios::binary);
+        std::ofstream output(copyPath, std::ios::binary | std::ios::trunc);
+        output << input.rdbuf();
+        if (!input || !output) {
+            LOGE("Cannot copy core for the second run-ahead instance");
+            output.close();
+            std::remove(copyPath.c_str());
+            return instance;
+        }
+    }
+
+    try {
+        instance.core = std::make_unique<Core>(copyPath);
+    } catch (std::exception& exception) {
+        LOGE("Cannot open second run-ahead instance: %s", exception.what());
+    }
+    std::remove(copyPath.c_str());
+
+    if (!instance.core) {
+        return instance;
+    }
+
+    secondaryLoadVariables = &variables;
+
+    instance.core->retro_set_video_refresh(&callback_hw_video_refresh);
+    instance.core->retro_set_environment(&callback_secondary_environment);
+    instance.core->retro_set_audio_sample(&callback_audio_sample);
+    instance.core->retro_set_audio_sample_batch(&callback_set_audio_sample_batch);
+    instance.core->retro_set_input_poll(&callback_retro_set_input_poll);
+    instance.core->retro_set_input_state(&callback_set_input_state);
+    instance.core->retro_init();
+
+    struct retro_system_info system_info {};
+    instance.core->retro_get_system_info(&system_info);
+
+    struct retro_game_info game_info {};
+    game_info.path = gamePath.c_str();
+    game_info.meta = nullptr;
+
+    bool loaded = false;
+    try {
+        // Each instance gets its own copy-on-write mapping, the page cache is still shared.
+        if (!system_info.need_fullpath) {
+            instance.gameFile = MappedFile::open(gamePath);
+            game_info.data = instance.gameFile->data();
+            game_info.size = instance.gameFile->size();
+        }
+        loaded = instance.core->retro_load_game(&game_info);
+    } catch (std::exception& exception) {
+        LOGE("Cannot read game for the second run-ahead instance: %s", exception.what());
+    }
+
+    secondaryLoadVariables = nullptr;
+
+    if (!loaded) {
+        LOGE("Cannot load game in the second run-ahead instance");
+        instance.core->retro_deinit();
+        instance.core = nullptr;
+        instance.gameFile = nullptr;
+    }
+
+    return instance;
+}
+
+void LibretroDroid::destroySecondaryCore() {
+    // Waits for a load still in progress, the instance is unloaded below like a swapped in one.
+    if (secondaryCoreLoad.valid()) {
+        SecondaryInstance instance = secondaryCoreLoad.get();
+        if (instance.core) {
+            secondaryCore = std::move(instance.core);
+            secondaryGameFile = std::move(instance.gameFile);
+        }
+    }
+
+    if (secondaryCore) {
+        secondaryCore->retro_unload_game();
+        secondaryCore->retro_deinit();
+        secondaryCore = nullptr;
+    }
+    secondaryGameFile = nullptr;
+    secondaryCoreFailed = false;
+}
+
+// The run-ahead instance only reads from the environment. Everything it registers would replace
+// what the main instance registered, like the disk control interface, and dangle once the copy
+// is unloaded. Setters are acknowledged and dropped.
+bool LibretroDroid::handleSecondaryEnvironment(unsigned cmd, void *data) {
+    Environment& environment = Environment::getInstance();
+
+    switch (cmd) {
+        case RETRO_ENVIRONMENT_GET_VARIABLE:
+            if (secondaryLoadVariables != nullptr) {
+                auto* requested = static_cast<struct retro_variable*>(data);
+                for (const Variable& variable : *secondaryLoadVariables) {
+                    if (variable.key == requested->key) {
+                        requested->value = variable.value.c_str();
+                        return true;
+                    }
+                }
+                return false;
+            }
+            return environment.handle_callback_environment(cmd, data);
+
+        case RETRO_ENVIRONMENT_GET_CAN_DUPE:
+        case RETRO_ENVIRONMENT_GET_LOG_INTERFACE:
+        case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
+        case RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY:
+        case RETRO_ENVIRONMENT_GET_LANGUAGE:
+        case RETRO_ENVIRONMENT_GET_VFS_INTERFACE:
+            return environment.handle_callback_environment(cmd, data);
+
+        // Tracked separately, so the main instance still sees its own updates.
+        case RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE: {
+            if (secondaryLoadVariables != nullptr) {
+                *((bool*) data) = false;
+                return true;
+            }
+
+            unsigned int generation = environment.getVariablesGeneration();
+            *((bool*) data) = generation != secondaryVariablesGeneration;
+            secondaryVariablesGeneration = generation;
+            return true;
+        }
+
+        // Frames of both instances go through the same renderer.
+        case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+            return *static_cast<enum retro_pixel_format *>(data) == environment.getPixelFormat();
+
+        case RETRO_ENVIRONMENT_SET_VARIABLES:
+        case RETRO_ENVIRONMENT_SET_ROTATION:
+        case RETRO_ENVIRONMENT_SET_DISK_CONTROL_INTERFACE:
+        case RETRO_ENVIRONMENT_SET_SYSTEM_AV_INFO:
+        case RETRO_ENVIRONMENT_SET_GEOMETRY:
+        case RETRO_ENVIRONMENT_SET_CONTROLLER_INFO:
+        case RETRO_ENVIRONMENT_SET_MEMORY_MAPS:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
 void LibretroDroid::setAudioEnabled(bool enabled) {
     audioEnabled = enabled;
 }
 
+void LibretroDroid::setAudioSync(bool enabled) {
+    audioSyncEnabled = enabled;
+}
+
+// Runs on the emulation thread, so the pacing can switch between two steps.
+void LibretroDroid::updateAudioSync() {
+    // Only pitched fast-forward produces audio as fast as the emulation runs.
+    bool fastForwardPaced = frameSpeed == 1 || fastForwardAudio == FastForwardAudio::PITCH;
+    bool active = audioSyncEnabled && audioEnabled && fastForwardPaced && !bfiEnabled && audio && fpsSync;
+    if (active == audioSyncActive) {
+        return;
+    }
+
+    audioSyncActive = active;
+    if (!audio || !fpsSync) {
+        return;
+    }
+
+    fpsSync->setAudioSync(active);
+    audio->setAudioSync(active);
+    audio->setInputSampleRate((int32_t) std::lround(contentSampleRate * fpsSync->getTimeStretchFactor()));
+}
+
+void LibretroDroid::setAudioDSP(const std::string& configPath) {
+    audioDSPConfig = configPath;
+    audioDSP = nullptr;
+
+    if (!audioDSPConfig.empty() && contentSampleRate > 0) {
+        audioDSP = AudioDSP::create(audioDSPConfig, contentSampleRate);
+    }
+}
+
+void LibretroDroid::setAudioResampler(Audio::ResamplerType type) {
+    audioResamplerType = type;
+    if (audio) {
+        audio->setResamplerType(type);
+    }
+}
+
 void LibretroDroid::setShaderConfig(ShaderManager::Config shaderConfig) {
     fragmentShaderConfig = std::move(shaderConfig);
     if (video) {
@@ -589,6 +1054,10 @@ void LibretroDroid::handleVideoRefresh(
     size_t pitch
 ) {
     LOGD("handleVideoRefresh: video=%p data=%p", video.get(), data);
+    if (suppressVideo) {
+        return;
+    }
+
     if (video) {
         video->onNewFrame(data, width, height, pitch);
 
@@ -604,10 +1073,68 @@ void LibretroDroid::handleVideoRefresh(
 }
 
 size_t LibretroDroid::handleAudioCallback(const int16_t *data, size_t frames) {
+    if (!audio || !audioEnabled || suppressAudio) {
+        return frames;
+    }
+
+    // Keeps the order for cores which use both callbacks.
+    flushAudioSamples();
+    submitAudio(data, frames);
+    return frames;
+}
+
+// Suppressed frames are filtered here, so everything staged can be submitted later.
+void LibretroDroid::handleAudioSample(int16_t left, int16_t right) {
+    if (!audio || !audioEnabled || suppressAudio) {
+        return;
+    }
+
+    if (audioSampleBatcher.push(left, right)) {
+        flushAudioSamples();
+    }
+}
+
+void LibretroDroid::flushAudioSamples() {
+    if (audioSampleBatcher.empty()) {
+        return;
+    }
+
     if (audio && audioEnabled) {
+        submitAudio(audioSampleBatcher.data(), audioSampleBatcher.size());
+    }
+    audioSampleBatcher.clear();
+}
+
+void LibretroDroid::submitAudio(const int16_t* data, size_t frames) {
+    bool fastForwarding = frameSpeed > 1;
+    if (fastForwarding && fastForwardAudio == FastForwardAudio::DROP) {
+        return;
+    }
+
+    if (fastForwarding && fastForwardAudio == FastForwardAudio::TIME_STRETCH && timeStretcher) {
+        auto [stretched, stretchedFrames] = timeStretcher->process(data, frames, frameSpeed);
+        writeAudio(stretched, stretchedFrames);
+        return;
+    }
+
+    // Leftovers from a previous fast-forward must not play when the next one starts.
+    if (timeStretcher) {
+        timeStretcher->reset();
+    }
+
+    writeAudio(data, frames);
+}
+
+void LibretroDroid::writeAudio(const int16_t* data, size_t frames) {
+    if (audioDSP) {
+        auto [filtered, filteredFrames] = audioDSP->process(data, frames);
+        data = filtered;
+        frames = filteredFrames;
+    }
+
+    if (frames > 0) {
         audio->write(data, frames);
     }
-    return frames;
 }
 
 int16_t LibretroDroid::handleSetInputState(
@@ -616,10 +1143,12 @@ int16_t LibretroDroid::handleSetInputState(
     unsigned int index,
     unsigned int id
 ) {
-    if (input) {
-        return input->getInputState(port, device, index, id);
+    int16_t result = input ? input->getInputState(port, device, index, id) : 0;
+
+    if (preemptiveFrames) {
+        preemptiveFrames->recordInput(port, device, index, id, result);
     }
-    return 0;
+    return result;
 }
 
 uintptr_t LibretroDroid::handleGetCurrentFrameBuffer() {
@@ -630,24 +1159,40 @@ uintptr_t LibretroDroid::handleGetCurrentFrameBuffer() {
 }
 
 void LibretroDroid::reset() {
+    if (preemptiveFrames) {
+        preemptiveFrames->clear();
+    }
     core->retro_reset();
 }
 
-std::pair<int8_t*, size_t> LibretroDroid::serializeState() {
-    size_t size = core->retro_serialize_size();
-    auto data = new int8_t[size];
+BufferPool::Buffer LibretroDroid::serializeState() {
+    auto buffer = serializeBufferPool.acquire(getSerializeSize());
+
+    serializeStateInto(buffer.data(), buffer.size());
+
+    return buffer;
+}
 
-    core->retro_serialize(data, size);
+size_t LibretroDroid::getSerializeSize() {
+    return core->retro_serialize_size();
+}
 
-    return std::pair(data, size);
+bool LibretroDroid::serializeStateInto(void* buffer, size_t size) {
+    return core->retro_serialize(buffer, size);
 }
 
 void LibretroDroid::resetCheat() {
     core->retro_cheat_reset();
+    if (secondaryCore) {
+        secondaryCore->retro_cheat_reset();
+    }
 }
 
 void LibretroDroid::setCheat(unsigned index, bool enabled, const std::string& code) {
     core->retro_cheat_set(index, enabled, Utils::cloneToCString(code));
+    if (secondaryCore) {
+        secondaryCore->retro_cheat_set(index, enabled, Utils::cloneToCString(code));
+    }
 }
 
 bool LibretroDroid::requiresVideoRefresh() const {
@@ -659,6 +1204,8 @@ void LibretroDroid::clearRequiresVideoRefresh() {
 }
 
 void LibretroDroid::afterGameLoad() {
+    memoryGeneration++;
+
     struct retro_system_av_info system_av_info {};
     core->retro_get_system_av_info(&system_av_info);
 
@@ -668,17 +1215,27 @@ void LibretroDroid::afterGameLoad() {
         fpsSync->setExternalTimingControl(true);
     }
 
+    contentSampleRate = system_av_info.timing.sample_rate;
+    timeStretcher = std::make_unique<TimeStretcher>((int32_t) std::lround(contentSampleRate));
+    audioSampleBatcher.clear();
+    setAudioDSP(audioDSPConfig);
+    audioSyncActive = false;
+
     double inputSampleRate = system_av_info.timing.sample_rate * fpsSync->getTimeStretchFactor();
 
     audio = std::make_unique<Audio>(
         (int32_t) std::lround(inputSampleRate),
         system_av_info.timing.fps,
-        preferLowLatencyAudio
+        preferLowLatencyAudio,
+        audioTelemetry
     );
 
     updateAudioSampleRateMultiplier();
+    audio->setResamplerType(audioResamplerType);
 
     defaultAspectRatio = findDefaultAspectRatio(system_av_info);
+
+    prepareSecondaryCore();
 }
 
 float LibretroDroid::findDefaultAspectRatio(const retro_system_av_info& system_av_info) {
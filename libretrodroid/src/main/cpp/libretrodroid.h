@@ -28,6 +28,8 @@
 #include <mutex>
 #include <memory>
 #include <optional>
+#include <atomic>
+#include <future>
 
 #include "log.h"
 #include "core.h"
@@ -46,6 +48,14 @@
 #include "renderers/es2/imagerendereres2.h"
 #include "renderers/es3/imagerendereres3.h"
 #include "utils/rect.h"
+#include "utils/frametimehistogram.h"
+#include "utils/bufferpool.h"
+#include "utils/mappedfile.h"
+#include "preemptiveframes.h"
+#include "srammonitor.h"
+#include "resamplers/timestretcher.h"
+#include "audiodsp.h"
+#include "utils/audiosamplebatcher.h"
 
 namespace libretrodroid {
 
@@ -65,18 +75,39 @@ private:
     LibretroDroid() {}
 
 public:
+    enum class FastForwardAudio {
+        PITCH = 0,
+        TIME_STRETCH = 1,
+        DROP = 2,
+    };
+
     void setCheat(unsigned index, bool enabled, const std::string& code);
     void resetCheat();
 
-    std::pair<int8_t*, size_t> serializeState();
+    BufferPool::Buffer serializeState();
+    size_t getSerializeSize();
+    bool serializeStateInto(void* buffer, size_t size);
     bool unserializeState(int8_t *data, size_t size);
 
-    std::pair<int8_t *, size_t> serializeSRAM();
     jboolean unserializeSRAM(int8_t *data, size_t size);
 
-    std::pair<int8_t *, size_t> getMemoryData(unsigned int memoryType);
+    // Points straight into the core memory, which retro_run keeps updating. The pointer stays
+    // valid until getMemoryGeneration() changes and must only be read from the GL thread, where
+    // the core runs. Returns a nullptr when the core does not expose this memory type.
+    std::pair<const int8_t*, size_t> getMemoryView(unsigned int memoryType);
     size_t getMemorySize(unsigned int memoryType);
 
+    // Changes whenever memory pointers handed out so far may have become invalid, that is when a
+    // game is loaded or unloaded.
+    uint64_t getMemoryGeneration() const { return memoryGeneration; }
+
+    // Incremental autosave: the monitor assumes the save file currently matches the save RAM,
+    // flushSRAM then only rewrites the pages which changed since.
+    void startSRAMMonitor(size_t pageSize);
+    void stopSRAMMonitor();
+    std::vector<uint32_t> getSRAMDirtyPages();
+    ssize_t flushSRAM(int fd);
+
     void onSurfaceCreated();
     void onSurfaceChanged(unsigned int width, unsigned int height);
 
@@ -93,7 +124,8 @@ public:
         bool enableMicrophone,
         bool duplicateFrames,
         std::optional<ImmersiveMode::Config> immersiveModeConfig,
-        const std::string& language
+        const std::string& language,
+        const std::string& cacheDir
     );
     void resume();
     void step();
@@ -136,9 +168,39 @@ public:
     void handleAchievementUnlocks(const std::function<void(uint32_t)>& handler);
     Achievements& getAchievements() { return achievements; }
 
+    FrameTimeHistogram& getStepTimeHistogram() { return stepTimeHistogram; }
+    AudioTelemetry& getAudioTelemetry() { return audioTelemetry; }
+    VideoTelemetry& getVideoTelemetry() { return videoTelemetry; }
+
     void setFrameSpeed(unsigned int speed);
 
+    // How audio behaves while fast-forwarding. PITCH plays everything faster, TIME_STRETCH keeps
+    // the pitch by dropping audio segments, DROP mutes it and skips the audio processing.
+    void setFastForwardAudio(FastForwardAudio mode);
+
+    // Presents the frame the core would produce runAheadFrames frames from now, hiding the
+    // game's own input lag. With useSecondInstance the look-ahead runs on a second copy of the
+    // core so the main one never reloads a state, which avoids audio glitches on some cores.
+    void setRunAhead(unsigned int frames, bool useSecondInstance);
+
+    // True when the second run-ahead instance cannot be used and run-ahead fell back to a
+    // single instance.
+    bool isRunAheadSecondInstanceFailed() const { return secondaryCoreFailed; }
+
+    // Cheaper alternative to run-ahead, only re-simulates the last frames when the input changed.
+    // Enabling one of the two latency modes disables the other.
+    void setPreemptiveFrames(unsigned int frames);
+    PreemptiveFrames* getPreemptiveFrames() { return preemptiveFrames.get(); }
+
     void setAudioEnabled(bool enabled);
+    void setAudioResampler(Audio::ResamplerType type);
+
+    // Paces the emulation with the audio clock instead of vsync or a timer. Has no effect while
+    // audio or black frame insertion are disabled.
+    void setAudioSync(bool enabled);
+
+    // Loads a RetroArch .dsp filter chain applied to the core audio, an empty path disables it.
+    void setAudioDSP(const std::string& configPath);
 
     void setShaderConfig(ShaderManager::Config shaderConfig);
     void setFilterMode(int mode);
@@ -155,10 +217,36 @@ public:
     uintptr_t handleGetCurrentFrameBuffer();
 
 private:
+    // A run-ahead instance loaded off the GL thread, swapped in once ready.
+    struct SecondaryInstance {
+        std::unique_ptr<Core> core;
+        std::unique_ptr<MappedFile> gameFile;
+        unsigned int variablesGeneration = 0;
+    };
+
     void updateAudioSampleRateMultiplier();
     float findDefaultAspectRatio(const retro_system_av_info &system_av_info);
     void afterGameLoad();
 
+    void runFrameWithRunAhead();
+    void runFrameWithPreemptiveFrames();
+    Core* getRunAheadCore();
+    void prepareSecondaryCore();
+    static SecondaryInstance loadSecondaryCore(
+        const std::string& corePath,
+        const std::string& copyPath,
+        const std::string& gamePath,
+        const std::vector<Variable>& variables
+    );
+    void destroySecondaryCore();
+    bool handleSecondaryEnvironment(unsigned cmd, void *data);
+
+    void updateAudioSync();
+    void handleAudioSample(int16_t left, int16_t right);
+    void flushAudioSamples();
+    void submitAudio(const int16_t* data, size_t frames);
+    void writeAudio(const int16_t* data, size_t frames);
+
 protected:
     static void callback_hw_video_refresh(const void *data, unsigned width, unsigned height, size_t pitch);
     static size_t callback_set_audio_sample_batch(const int16_t* data, size_t frames);
@@ -166,13 +254,48 @@ protected:
     static int16_t callback_set_input_state(unsigned port, unsigned device, unsigned index, unsigned id);
     static uintptr_t callback_get_current_framebuffer();
     static void callback_retro_set_input_poll();
+    static bool callback_secondary_environment(unsigned cmd, void *data);
 
 private:
     unsigned int frameSpeed = 1;
     bool audioEnabled = true;
+    Audio::ResamplerType audioResamplerType = Audio::ResamplerType::LINEAR;
     bool preferLowLatencyAudio = false;
+    FastForwardAudio fastForwardAudio = FastForwardAudio::PITCH;
+    std::unique_ptr<TimeStretcher> timeStretcher;
+    AudioSampleBatcher audioSampleBatcher;
+    std::string audioDSPConfig;
+    std::unique_ptr<AudioDSP> audioDSP;
+    bool audioSyncEnabled = false;
+    bool audioSyncActive = false;
+    double contentSampleRate = 0.0;
     bool rumbleEnabled = false;
 
+    unsigned int runAheadFrames = 0;
+    bool runAheadSecondInstance = false;
+    bool runAheadFailed = false;
+    bool suppressVideo = false;
+    bool suppressAudio = false;
+    std::vector<uint8_t> runAheadState;
+
+    std::string coreFilePath;
+    std::string gameFilePath;
+    std::string cacheDirectory;
+    std::future<SecondaryInstance> secondaryCoreLoad;
+    std::unique_ptr<Core> secondaryCore;
+    std::unique_ptr<MappedFile> secondaryGameFile;
+    bool secondaryCoreFailed = false;
+    unsigned int secondaryVariablesGeneration = 0;
+
+    std::unique_ptr<PreemptiveFrames> preemptiveFrames;
+
+    std::unique_ptr<SRAMMonitor> sramMonitor;
+
+    std::unique_ptr<MappedFile> gameFile;
+
+    // Below this fill level audio sync runs two frames per step to catch up.
+    static constexpr float AUDIO_SYNC_CATCH_UP_LEVEL = 0.25f;
+
     ShaderManager::Config fragmentShaderConfig = ShaderManager::Config {
         ShaderManager::Type::SHADER_DEFAULT, { }
     };
@@ -197,6 +320,12 @@ private:
     std::unique_ptr<Input> input;
     std::unique_ptr<Rumble> rumble;
     Achievements achievements;
+
+    FrameTimeHistogram stepTimeHistogram;
+    AudioTelemetry audioTelemetry;
+    VideoTelemetry videoTelemetry;
+    BufferPool serializeBufferPool;
+    std::atomic<uint64_t> memoryGeneration { 0 };
 };
 
 } //namespace libretrodroid
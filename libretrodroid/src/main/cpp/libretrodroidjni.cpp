@@ -19,6 +19,9 @@
 
 #include <EGL/egl.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
@@ -44,6 +47,8 @@
 #include "renderers/es3/imagerendereres3.h"
 #include "utils/jnistring.h"
 #include "rewindbuffer.h"
+#include "rewindcapture.h"
+#include "utils/frametimehistogram.h"
 #include "achievements_test.h"
 #include <rc_hash.h>
 
@@ -199,12 +204,10 @@ JNIEXPORT jbyteArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_seri
     jclass obj
 ) {
     try {
-        auto [data, size] = LibretroDroid::getInstance().serializeState();
+        auto buffer = LibretroDroid::getInstance().serializeState();
 
-        jbyteArray result = env->NewByteArray(size);
-        env->SetByteArrayRegion(result, 0, size, data);
-
-        delete[] data;
+        jbyteArray result = env->NewByteArray(buffer.size());
+        env->SetByteArrayRegion(result, 0, buffer.size(), buffer.data());
 
         return result;
 
@@ -216,6 +219,53 @@ JNIEXPORT jbyteArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_seri
     return nullptr;
 }
 
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getSerializeSize(
+    JNIEnv* env,
+    jclass obj
+) {
+    try {
+        return LibretroDroid::getInstance().getSerializeSize();
+    } catch (std::exception &exception) {
+        LOGE("Error in getSerializeSize: %s", exception.what());
+    }
+    return 0;
+}
+
+// Returns the address of a direct ByteBuffer if it can hold at least size bytes.
+static void* directBufferFor(JNIEnv* env, jobject buffer, size_t size) {
+    void* address = env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (address == nullptr || capacity < 0 || static_cast<size_t>(capacity) < size) {
+        return nullptr;
+    }
+    return address;
+}
+
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_serializeStateInto(
+    JNIEnv* env,
+    jclass obj,
+    jobject buffer
+) {
+    try {
+        size_t size = LibretroDroid::getInstance().getSerializeSize();
+        void* target = directBufferFor(env, buffer, size);
+        if (target == nullptr) {
+            return -1;
+        }
+
+        if (!LibretroDroid::getInstance().serializeStateInto(target, size)) {
+            return -1;
+        }
+        return static_cast<jint>(size);
+
+    } catch (std::exception &exception) {
+        LOGE("Error in serializeStateInto: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+    }
+
+    return -1;
+}
+
 JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setCheat(
     JNIEnv* env,
     jclass obj,
@@ -272,12 +322,12 @@ JNIEXPORT jbyteArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_seri
     jclass obj
 ) {
     try {
-        auto [data, size] = LibretroDroid::getInstance().serializeSRAM();
+        auto [data, size] = LibretroDroid::getInstance().getMemoryView(RETRO_MEMORY_SAVE_RAM);
 
         jbyteArray result = env->NewByteArray(size);
-        env->SetByteArrayRegion(result, 0, size, (jbyte *) data);
-
-        delete[] data;
+        if (data != nullptr) {
+            env->SetByteArrayRegion(result, 0, size, data);
+        }
 
         return result;
 
@@ -295,14 +345,13 @@ JNIEXPORT jbyteArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getM
     jint memoryType
 ) {
     try {
-        auto [data, size] = LibretroDroid::getInstance().getMemoryData(memoryType);
+        auto [data, size] = LibretroDroid::getInstance().getMemoryView(memoryType);
         if (data == nullptr) {
             return nullptr;
         }
 
         jbyteArray result = env->NewByteArray(size);
-        env->SetByteArrayRegion(result, 0, size, (jbyte*) data);
-        delete[] data;
+        env->SetByteArrayRegion(result, 0, size, data);
         return result;
 
     } catch (std::exception &exception) {
@@ -312,6 +361,219 @@ JNIEXPORT jbyteArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getM
     return nullptr;
 }
 
+JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMemoryDataInto(
+    JNIEnv* env,
+    jclass obj,
+    jint memoryType,
+    jobject buffer
+) {
+    try {
+        auto [data, size] = LibretroDroid::getInstance().getMemoryView(memoryType);
+        if (data == nullptr) {
+            return -1;
+        }
+
+        void* target = directBufferFor(env, buffer, size);
+        if (target == nullptr) {
+            return -1;
+        }
+
+        memcpy(target, data, size);
+        return static_cast<jint>(size);
+
+    } catch (std::exception &exception) {
+        LOGE("Error in getMemoryDataInto: %s", exception.what());
+    }
+
+    return -1;
+}
+
+// Every view handed out over core memory is a read-only wrapper tracked here, so destroy can
+// empty them before the memory goes away. Stale readers then hit an IndexOutOfBoundsException
+// instead of freed memory.
+static std::mutex memoryViewsMutex;
+static std::vector<jweak> memoryViews;
+
+static jobject newMemoryView(JNIEnv* env, void* data, size_t size) {
+    jobject direct = env->NewDirectByteBuffer(data, size);
+    if (direct == nullptr) {
+        return nullptr;
+    }
+
+    jclass bufferClass = env->FindClass("java/nio/ByteBuffer");
+    jmethodID asReadOnlyBuffer = env->GetMethodID(bufferClass, "asReadOnlyBuffer", "()Ljava/nio/ByteBuffer;");
+    jobject view = env->CallObjectMethod(direct, asReadOnlyBuffer);
+    env->DeleteLocalRef(direct);
+    env->DeleteLocalRef(bufferClass);
+
+    if (view != nullptr) {
+        std::lock_guard<std::mutex> lock(memoryViewsMutex);
+        memoryViews.erase(
+            std::remove_if(memoryViews.begin(), memoryViews.end(), [env](jweak weak) {
+                bool collected = env->IsSameObject(weak, nullptr);
+                if (collected) env->DeleteWeakGlobalRef(weak);
+                return collected;
+            }),
+            memoryViews.end()
+        );
+        memoryViews.push_back(env->NewWeakGlobalRef(view));
+    }
+    return view;
+}
+
+static void invalidateMemoryViews(JNIEnv* env) {
+    std::lock_guard<std::mutex> lock(memoryViewsMutex);
+    if (memoryViews.empty()) {
+        return;
+    }
+
+    jclass bufferClass = env->FindClass("java/nio/Buffer");
+    jmethodID limit = env->GetMethodID(bufferClass, "limit", "(I)Ljava/nio/Buffer;");
+
+    for (jweak weak : memoryViews) {
+        jobject view = env->NewLocalRef(weak);
+        if (view != nullptr) {
+            env->DeleteLocalRef(env->CallObjectMethod(view, limit, 0));
+            env->DeleteLocalRef(view);
+        }
+        env->DeleteWeakGlobalRef(weak);
+    }
+    memoryViews.clear();
+    env->DeleteLocalRef(bufferClass);
+}
+
+JNIEXPORT jobject JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMemoryView(
+    JNIEnv* env,
+    jclass obj,
+    jint memoryType
+) {
+    try {
+        auto [data, size] = LibretroDroid::getInstance().getMemoryView(memoryType);
+        if (data == nullptr) {
+            return nullptr;
+        }
+
+        return newMemoryView(env, const_cast<int8_t*>(data), size);
+
+    } catch (std::exception &exception) {
+        LOGE("Error in getMemoryView: %s", exception.what());
+    }
+
+    return nullptr;
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMemoryDescriptors(
+    JNIEnv* env,
+    jclass obj
+) {
+    jclass descriptorClass = env->FindClass("com/swordfish/libretrodroid/MemoryDescriptor");
+    jmethodID descriptorConstructor = env->GetMethodID(
+        descriptorClass,
+        "<init>",
+        "(JJJJJLjava/lang/String;Ljava/nio/ByteBuffer;)V"
+    );
+
+    const struct retro_memory_map* memoryMap = Environment::getInstance().getMemoryMap();
+    unsigned count = memoryMap != nullptr ? memoryMap->num_descriptors : 0;
+
+    jobjectArray result = env->NewObjectArray(count, descriptorClass, nullptr);
+
+    for (unsigned i = 0; i < count; i++) {
+        const struct retro_memory_descriptor& descriptor = memoryMap->descriptors[i];
+
+        jobject view = nullptr;
+        if (descriptor.ptr != nullptr && descriptor.len > 0) {
+            view = newMemoryView(
+                env,
+                static_cast<uint8_t*>(descriptor.ptr) + descriptor.offset,
+                descriptor.len
+            );
+        }
+
+        jstring addressSpace = descriptor.addrspace != nullptr
+            ? env->NewStringUTF(descriptor.addrspace)
+            : nullptr;
+
+        jobject jDescriptor = env->NewObject(
+            descriptorClass,
+            descriptorConstructor,
+            (jlong) descriptor.flags,
+            (jlong) descriptor.start,
+            (jlong) descriptor.select,
+            (jlong) descriptor.disconnect,
+            (jlong) descriptor.len,
+            addressSpace,
+            view
+        );
+
+        env->SetObjectArrayElement(result, i, jDescriptor);
+        env->DeleteLocalRef(jDescriptor);
+        if (view != nullptr) env->DeleteLocalRef(view);
+        if (addressSpace != nullptr) env->DeleteLocalRef(addressSpace);
+    }
+
+    return result;
+}
+
+JNIEXPORT jlong JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMemoryGeneration(
+    JNIEnv* env,
+    jclass obj
+) {
+    return static_cast<jlong>(LibretroDroid::getInstance().getMemoryGeneration());
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_startSRAMMonitor(
+    JNIEnv* env,
+    jclass obj,
+    jint pageSize
+) {
+    try {
+        LibretroDroid::getInstance().startSRAMMonitor(pageSize > 0 ? pageSize : SRAMMonitor::DEFAULT_PAGE_SIZE);
+    } catch (std::exception &exception) {
+        LOGE("Error in startSRAMMonitor: %s", exception.what());
+    }
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_stopSRAMMonitor(
+    JNIEnv* env,
+    jclass obj
+) {
+    LibretroDroid::getInstance().stopSRAMMonitor();
+}
+
+JNIEXPORT jintArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getSRAMDirtyPages(
+    JNIEnv* env,
+    jclass obj
+) {
+    try {
+        auto pages = LibretroDroid::getInstance().getSRAMDirtyPages();
+
+        jintArray result = env->NewIntArray(pages.size());
+        env->SetIntArrayRegion(result, 0, pages.size(), reinterpret_cast<const jint*>(pages.data()));
+        return result;
+
+    } catch (std::exception &exception) {
+        LOGE("Error in getSRAMDirtyPages: %s", exception.what());
+    }
+
+    return nullptr;
+}
+
+JNIEXPORT jlong JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_flushSRAM(
+    JNIEnv* env,
+    jclass obj,
+    jint fd
+) {
+    try {
+        return LibretroDroid::getInstance().flushSRAM(fd);
+    } catch (std::exception &exception) {
+        LOGE("Error in flushSRAM: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_SERIALIZATION);
+    }
+
+    return -1;
+}
+
 JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getMemorySize(
     JNIEnv* env,
     jclass obj,
@@ -398,11 +660,13 @@ JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_create(
     jboolean enableMicrophone,
     jboolean skipDuplicateFrames,
     jobject immersiveMode,
-    jstring language
+    jstring language,
+    jstring cacheDir
 ) {
     try {
         auto corePath = JniString(env, soFilePath);
         auto deviceLanguage = JniString(env, language);
+        auto cacheDirectory = JniString(env, cacheDir);
         auto systemDirectory = JniString(env, systemDir);
         auto savesDirectory = JniString(env, savesDir);
 
@@ -447,7 +711,8 @@ JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_create(
             enableMicrophone,
             skipDuplicateFrames,
             parsedConfig,
-            deviceLanguage.stdString()
+            deviceLanguage.stdString(),
+            cacheDirectory.stdString()
         );
 
     } catch (libretrodroid::LibretroDroidError& exception) {
@@ -537,6 +802,7 @@ JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_destroy(
     jclass obj
 ) {
     try {
+        invalidateMemoryViews(env);
         LibretroDroid::getInstance().destroy();
     } catch (std::exception &exception) {
         LOGE("Error in destroy: %s", exception.what());
@@ -613,6 +879,53 @@ JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setFrameSp
     LibretroDroid::getInstance().setFrameSpeed(speed);
 }
 
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setRunAhead(
+    JNIEnv* env,
+    jclass obj,
+    jint frames,
+    jboolean useSecondInstance
+) {
+    LibretroDroid::getInstance().setRunAhead(frames, useSecondInstance);
+}
+
+JNIEXPORT jboolean JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_isRunAheadSecondInstanceFailed(
+    JNIEnv* env,
+    jclass obj
+) {
+    return LibretroDroid::getInstance().isRunAheadSecondInstanceFailed();
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setPreemptiveFrames(
+    JNIEnv* env,
+    jclass obj,
+    jint frames
+) {
+    LibretroDroid::getInstance().setPreemptiveFrames(frames);
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getPreemptiveFramesStats(
+    JNIEnv* env,
+    jclass obj
+) {
+    PreemptiveFrames::Stats stats {};
+    if (auto preemptiveFrames = LibretroDroid::getInstance().getPreemptiveFrames()) {
+        stats = preemptiveFrames->getStats();
+    }
+
+    jlong values[] = {
+        static_cast<jlong>(stats.rollbacks),
+        static_cast<jlong>(stats.serializeCount),
+        static_cast<jlong>(stats.serializeTimeUs),
+        static_cast<jlong>(stats.unserializeCount),
+        static_cast<jlong>(stats.unserializeTimeUs),
+    };
+
+    jsize count = sizeof(values) / sizeof(values[0]);
+    jlongArray result = env->NewLongArray(count);
+    env->SetLongArrayRegion(result, 0, count, values);
+    return result;
+}
+
 JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setAudioEnabled(
     JNIEnv* env,
     jclass obj,
@@ -621,6 +934,47 @@ JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setAudioEn
     LibretroDroid::getInstance().setAudioEnabled(enabled);
 }
 
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setFastForwardAudio(
+    JNIEnv* env,
+    jclass obj,
+    jint mode
+) {
+    LibretroDroid::getInstance().setFastForwardAudio(static_cast<LibretroDroid::FastForwardAudio>(mode));
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setAudioDSP(
+    JNIEnv* env,
+    jclass obj,
+    jstring configPath
+) {
+    try {
+        std::string path;
+        if (configPath != nullptr) {
+            path = JniString(env, configPath).stdString();
+        }
+        LibretroDroid::getInstance().setAudioDSP(path);
+    } catch (std::exception &exception) {
+        LOGE("Error in setAudioDSP: %s", exception.what());
+        JavaUtils::throwRetroException(env, ERROR_GENERIC);
+    }
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setAudioSync(
+    JNIEnv* env,
+    jclass obj,
+    jboolean enabled
+) {
+    LibretroDroid::getInstance().setAudioSync(enabled);
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setAudioResampler(
+    JNIEnv* env,
+    jclass obj,
+    jint resampler
+) {
+    LibretroDroid::getInstance().setAudioResampler(static_cast<Audio::ResamplerType>(resampler));
+}
+
 JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setShaderConfig(
     JNIEnv* env,
     jclass obj,
@@ -697,14 +1051,72 @@ JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setRotatio
 static std::unique_ptr<RewindBuffer> rewindBuffer = nullptr;
 static std::vector<uint8_t> rewindTempBuffer;
 
+static constexpr size_t REWIND_CAPTURE_POOL_SIZE = 4;
+static std::unique_ptr<AsyncRewindCapture> rewindCapture = nullptr;
+static bool rewindCaptureAsync = false;
+static FrameTimeHistogram rewindCaptureTimeHistogram;
+
+static jlongArray histogramToJava(JNIEnv* env, const FrameTimeHistogram& histogram) {
+    auto buckets = histogram.getBuckets();
+    jlong values[FrameTimeHistogram::BUCKET_COUNT];
+    for (size_t i = 0; i < FrameTimeHistogram::BUCKET_COUNT; i++) {
+        values[i] = static_cast<jlong>(buckets[i]);
+    }
+
+    jlongArray result = env->NewLongArray(FrameTimeHistogram::BUCKET_COUNT);
+    env->SetLongArrayRegion(result, 0, FrameTimeHistogram::BUCKET_COUNT, values);
+    return result;
+}
+
 JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_initRewindBuffer(
     JNIEnv* env,
     jclass obj,
     jint slotCount,
-    jint maxStateSize
+    jint maxStateSize,
+    jint mode,
+    jlong budgetBytes,
+    jint codec
 ) {
-    rewindBuffer = std::make_unique<RewindBuffer>(slotCount, maxStateSize);
+    if (slotCount < 0 || maxStateSize < 0 || budgetBytes < 0) {
+        LOGE("Invalid rewind buffer parameters: slots=%d, stateSize=%d, budget=%lld",
+             slotCount, maxStateSize, (long long) budgetBytes);
+        return;
+    }
+
+    rewindCapture.reset();
+    rewindBuffer = std::make_unique<RewindBuffer>(
+        slotCount,
+        maxStateSize,
+        static_cast<RewindBuffer::Mode>(mode),
+        static_cast<size_t>(budgetBytes),
+        static_cast<RewindCodec::Type>(codec)
+    );
     rewindTempBuffer.resize(maxStateSize);
+
+    if (rewindCaptureAsync) {
+        rewindCapture = std::make_unique<AsyncRewindCapture>(
+            *rewindBuffer,
+            REWIND_CAPTURE_POOL_SIZE,
+            maxStateSize
+        );
+    }
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_setRewindCaptureAsync(
+    JNIEnv* env,
+    jclass obj,
+    jboolean enabled
+) {
+    rewindCaptureAsync = enabled;
+    rewindCapture.reset();
+
+    if (rewindCaptureAsync && rewindBuffer) {
+        rewindCapture = std::make_unique<AsyncRewindCapture>(
+            *rewindBuffer,
+            REWIND_CAPTURE_POOL_SIZE,
+            rewindTempBuffer.size()
+        );
+    }
 }
 
 JNIEXPORT jboolean JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_captureRewindState(
@@ -715,10 +1127,38 @@ JNIEXPORT jboolean JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_captur
         return JNI_FALSE;
     }
 
+    ScopedFrameTimer timer(rewindCaptureTimeHistogram);
+
     try {
-        auto [data, size] = LibretroDroid::getInstance().serializeState();
-        rewindBuffer->push(reinterpret_cast<uint8_t*>(data), size);
-        delete[] data;
+        size_t size = LibretroDroid::getInstance().getSerializeSize();
+
+        if (rewindCapture) {
+            uint8_t* target = rewindCapture->acquire(size);
+            if (target == nullptr) {
+                return JNI_FALSE;
+            }
+
+            if (!LibretroDroid::getInstance().serializeStateInto(target, size)) {
+                rewindCapture->cancel();
+                return JNI_FALSE;
+            }
+
+            rewindCapture->submit(size);
+            return JNI_TRUE;
+        }
+
+        // Serialize straight into the rewind slot to avoid an allocation and a copy per frame.
+        uint8_t* target = rewindBuffer->beginPush(size);
+        if (target == nullptr) {
+            return JNI_FALSE;
+        }
+
+        if (!LibretroDroid::getInstance().serializeStateInto(target, size)) {
+            rewindBuffer->cancelPush();
+            return JNI_FALSE;
+        }
+
+        rewindBuffer->commitPush(size);
         return JNI_TRUE;
     } catch (std::exception &exception) {
         LOGE("Error in captureRewindState: %s", exception.what());
@@ -735,6 +1175,10 @@ JNIEXPORT jboolean JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_rewind
     }
 
     try {
+        if (rewindCapture) {
+            rewindCapture->flush();
+        }
+
         size_t size = 0;
         if (!rewindBuffer->pop(rewindTempBuffer.data(), &size)) {
             return JNI_FALSE;
@@ -755,6 +1199,9 @@ JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_clearRewin
     JNIEnv* env,
     jclass obj
 ) {
+    if (rewindCapture) {
+        rewindCapture->flush();
+    }
     if (rewindBuffer) {
         rewindBuffer->clear();
     }
@@ -764,6 +1211,7 @@ JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_destroyRew
     JNIEnv* env,
     jclass obj
 ) {
+    rewindCapture.reset();
     rewindBuffer.reset();
     rewindTempBuffer.clear();
     rewindTempBuffer.shrink_to_fit();
@@ -789,6 +1237,141 @@ JNIEXPORT jint JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getRewindB
     return static_cast<jint>(rewindBuffer->getValidCount());
 }
 
+JNIEXPORT jlong JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getRewindBufferUsedBytes(
+    JNIEnv* env,
+    jclass obj
+) {
+    if (!rewindBuffer) {
+        return 0;
+    }
+    return static_cast<jlong>(rewindBuffer->getUsedBytes());
+}
+
+JNIEXPORT jlong JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getRewindBufferCapacityBytes(
+    JNIEnv* env,
+    jclass obj
+) {
+    if (!rewindBuffer) {
+        return 0;
+    }
+    return static_cast<jlong>(rewindBuffer->getCapacityBytes());
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getStepTimeHistogram(
+    JNIEnv* env,
+    jclass obj
+) {
+    return histogramToJava(env, LibretroDroid::getInstance().getStepTimeHistogram());
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getRewindCaptureTimeHistogram(
+    JNIEnv* env,
+    jclass obj
+) {
+    return histogramToJava(env, rewindCaptureTimeHistogram);
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_resetFrameTimeHistograms(
+    JNIEnv* env,
+    jclass obj
+) {
+    LibretroDroid::getInstance().getStepTimeHistogram().reset();
+    rewindCaptureTimeHistogram.reset();
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getAudioTelemetry(
+    JNIEnv* env,
+    jclass obj
+) {
+    AudioTelemetry::Snapshot snapshot = LibretroDroid::getInstance().getAudioTelemetry().getSnapshot();
+
+    uint64_t averageCallbackFrames = snapshot.callbacks > 0
+        ? snapshot.totalCallbackFrames / snapshot.callbacks
+        : 0;
+
+    jlong values[] = {
+        static_cast<jlong>(snapshot.callbacks),
+        static_cast<jlong>(snapshot.underruns),
+        static_cast<jlong>(snapshot.underrunFrames),
+        static_cast<jlong>(snapshot.overruns),
+        static_cast<jlong>(snapshot.overrunFrames),
+        static_cast<jlong>(snapshot.xRuns),
+        static_cast<jlong>(snapshot.requestedCallbackFrames),
+        static_cast<jlong>(snapshot.lastCallbackFrames),
+        static_cast<jlong>(snapshot.minCallbackFrames),
+        static_cast<jlong>(snapshot.maxCallbackFrames),
+        static_cast<jlong>(averageCallbackFrames),
+        static_cast<jlong>(std::lround(snapshot.fillP5 * 100)),
+        static_cast<jlong>(std::lround(snapshot.fillP50 * 100)),
+        static_cast<jlong>(std::lround(snapshot.fillP95 * 100)),
+    };
+
+    jsize count = sizeof(values) / sizeof(values[0]);
+    jlongArray result = env->NewLongArray(count);
+    env->SetLongArrayRegion(result, 0, count, values);
+    return result;
+}
+
+JNIEXPORT jfloatArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getAudioControllerTrace(
+    JNIEnv* env,
+    jclass obj
+) {
+    std::vector<AudioTelemetry::ControllerSample> samples(AudioTelemetry::CONTROLLER_TRACE_SIZE);
+    size_t count = LibretroDroid::getInstance().getAudioTelemetry().getControllerTrace(
+        samples.data(),
+        samples.size()
+    );
+
+    std::vector<jfloat> values;
+    values.reserve(count * 3);
+    for (size_t i = 0; i < count; i++) {
+        values.push_back(samples[i].error);
+        values.push_back(samples[i].proportional);
+        values.push_back(samples[i].integral);
+    }
+
+    jfloatArray result = env->NewFloatArray((jsize) values.size());
+    env->SetFloatArrayRegion(result, 0, (jsize) values.size(), values.data());
+    return result;
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_resetAudioTelemetry(
+    JNIEnv* env,
+    jclass obj
+) {
+    LibretroDroid::getInstance().getAudioTelemetry().reset();
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_getVideoTelemetry(
+    JNIEnv* env,
+    jclass obj
+) {
+    VideoTelemetry::Snapshot snapshot = LibretroDroid::getInstance().getVideoTelemetry().getSnapshot();
+
+    jlong values[] = {
+        static_cast<jlong>(snapshot.uploads),
+        static_cast<jlong>(snapshot.pixelBufferUploads),
+        static_cast<jlong>(snapshot.fenceWaits),
+        static_cast<jlong>(snapshot.fenceWaitNanos),
+        static_cast<jlong>(snapshot.skippedUploads),
+        static_cast<jlong>(snapshot.partialUploads),
+        static_cast<jlong>(snapshot.bytesUploaded),
+        static_cast<jlong>(snapshot.lastFrameBytesUploaded),
+    };
+
+    jsize count = sizeof(values) / sizeof(values[0]);
+    jlongArray result = env->NewLongArray(count);
+    env->SetLongArrayRegion(result, 0, count, values);
+    return result;
+}
+
+JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_resetVideoTelemetry(
+    JNIEnv* env,
+    jclass obj
+) {
+    LibretroDroid::getInstance().getVideoTelemetry().reset();
+}
+
 JNIEXPORT void JNICALL Java_com_swordfish_libretrodroid_LibretroDroid_initAchievements(
     JNIEnv* env,
     jclass obj,
@@ -0,0 +1,123 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "preemptiveframes.h"
+
+#include <chrono>
+
+namespace libretrodroid {
+
+static uint64_t elapsedMicros(std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+PreemptiveFrames::PreemptiveFrames(unsigned frames)
+    : frames(frames), states(frames), stateSizes(frames) { }
+
+void PreemptiveFrames::recordInput(unsigned port, unsigned device, unsigned index, unsigned id, int16_t value) {
+    // Cores usually poll the same few inputs many times per frame, only the first read matters.
+    for (const auto& input : polledInputs) {
+        if (input.port == port && input.device == device && input.index == index && input.id == id) {
+            return;
+        }
+    }
+    polledInputs.push_back(PolledInput { port, device, index, id, value });
+}
+
+void PreemptiveFrames::clearInputs() {
+    polledInputs.clear();
+}
+
+bool PreemptiveFrames::hasInputChanged(const InputQuery& query) const {
+    for (const auto& input : polledInputs) {
+        if (query(input.port, input.device, input.index, input.id) != input.value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PreemptiveFrames::pushState(Core& core) {
+    if (states.empty()) {
+        return false;
+    }
+
+    if (isFull()) {
+        stateHead = (stateHead + 1) % states.size();
+        stateCount--;
+    }
+
+    size_t slot = (stateHead + stateCount) % states.size();
+    size_t size = core.retro_serialize_size();
+    if (states[slot].size() < size) {
+        states[slot].resize(size);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool result = size > 0 && core.retro_serialize(states[slot].data(), size);
+    serializeTimeUs += elapsedMicros(start);
+    serializeCount++;
+
+    if (!result) {
+        return false;
+    }
+
+    stateSizes[slot] = size;
+    stateCount++;
+    return true;
+}
+
+bool PreemptiveFrames::rollback(Core& core) {
+    if (stateCount == 0) {
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool result = core.retro_unserialize(states[stateHead].data(), stateSizes[stateHead]);
+    unserializeTimeUs += elapsedMicros(start);
+    unserializeCount++;
+    rollbacks++;
+
+    clear();
+    return result;
+}
+
+void PreemptiveFrames::clear() {
+    stateHead = 0;
+    stateCount = 0;
+}
+
+PreemptiveFrames::Stats PreemptiveFrames::getStats() const {
+    return Stats {
+        rollbacks.load(),
+        serializeCount.load(),
+        serializeTimeUs.load(),
+        unserializeCount.load(),
+        unserializeTimeUs.load()
+    };
+}
+
+void PreemptiveFrames::resetStats() {
+    rollbacks = 0;
+    serializeCount = 0;
+    serializeTimeUs = 0;
+    unserializeCount = 0;
+    unserializeTimeUs = 0;
+}
+
+}
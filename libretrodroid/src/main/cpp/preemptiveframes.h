@@ -0,0 +1,97 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_PREEMPTIVEFRAMES_H
+#define LIBRETRODROID_PREEMPTIVEFRAMES_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "core.h"
+
+namespace libretrodroid {
+
+// Keeps the states of the last few frames and the inputs the core polled. When the input changes
+// the emulation rolls back to the oldest state and replays the frames with the new input, so the
+// change shows up as if it happened that many frames earlier. Frames without input changes cost
+// a single serialize on top of retro_run.
+class PreemptiveFrames {
+public:
+    using InputQuery = std::function<int16_t(unsigned port, unsigned device, unsigned index, unsigned id)>;
+
+    struct Stats {
+        uint64_t rollbacks;
+        uint64_t serializeCount;
+        uint64_t serializeTimeUs;
+        uint64_t unserializeCount;
+        uint64_t unserializeTimeUs;
+    };
+
+    explicit PreemptiveFrames(unsigned frames);
+
+    unsigned getFrames() const { return frames; }
+
+    // Records an input value returned to the core during the current frame.
+    void recordInput(unsigned port, unsigned device, unsigned index, unsigned id, int16_t value);
+    void clearInputs();
+
+    // True when any input polled during the last frame now reads differently.
+    bool hasInputChanged(const InputQuery& query) const;
+
+    // Saves the state at the start of a frame, dropping the oldest one when full.
+    bool pushState(Core& core);
+
+    // Loads the oldest state and forgets every saved one, replayed frames push them back.
+    bool rollback(Core& core);
+
+    bool isFull() const { return stateCount == states.size(); }
+    void clear();
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    struct PolledInput {
+        unsigned port;
+        unsigned device;
+        unsigned index;
+        unsigned id;
+        int16_t value;
+    };
+
+private:
+    unsigned frames;
+
+    std::vector<std::vector<uint8_t>> states;
+    std::vector<size_t> stateSizes;
+    size_t stateHead = 0;
+    size_t stateCount = 0;
+
+    std::vector<PolledInput> polledInputs;
+
+    std::atomic<uint64_t> rollbacks { 0 };
+    std::atomic<uint64_t> serializeCount { 0 };
+    std::atomic<uint64_t> serializeTimeUs { 0 };
+    std::atomic<uint64_t> unserializeCount { 0 };
+    std::atomic<uint64_t> unserializeTimeUs { 0 };
+};
+
+}
+
+#endif //LIBRETRODROID_PREEMPTIVEFRAMES_H
@@ -20,22 +20,23 @@
 
 namespace libretrodroid {
 
-ImageRendererES2::ImageRendererES2() {
+ImageRendererES2::ImageRendererES2(VideoTelemetry& telemetry) : telemetry(telemetry) {
     glGenTextures(1, &currentTexture);
     glBindTexture(GL_TEXTURE_2D, currentTexture);
 }
 
 void ImageRendererES2::onNewFrame(const void *data, unsigned width, unsigned height, size_t pitch) {
+    const std::vector<FrameDiff::Band>& bands = frameDiff.update(data, width, height, pitch, bytesPerPixel);
+    if (bands.empty()) {
+        telemetry.recordSkippedUpload();
+        Renderer::onNewFrame(data, width, height, pitch);
+        return;
+    }
+
     glBindTexture(GL_TEXTURE_2D, currentTexture);
 
     glPixelStorei(GL_UNPACK_ALIGNMENT, bytesPerPixel);
 
-    if (pixelFormat == RETRO_PIXEL_FORMAT_XRGB8888) {
-        convertDataFromRGB8888(data, pitch * height);
-    } else if (pixelFormat == RETRO_PIXEL_FORMAT_0RGB1555) {
-        convertDataFrom0RGB1555(data, width, height, pitch);
-    }
-
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, linear ? GL_LINEAR : GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, linear ? GL_LINEAR : GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -45,31 +46,41 @@ void ImageRendererES2::onNewFrame(const void *data, unsigned width, unsigned hei
         glTexImage2D(GL_TEXTURE_2D, 0, glInternalFormat, width, height, 0, glFormat, glType, nullptr);
     }
 
-    // If the given texture has the correct size we just upload it.
-    if (bytesPerPixel * width == pitch) {
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, glFormat, glType, data);
-    } else {
-        // Here we are forced to take the long and slow way to upload the padded texture.
-        for (int i = 0; i < height; i++) {
-            auto row = (char*) data + (pitch) * i;
-            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, i, width, 1, glFormat, glType, row);
-        }
+    size_t uploadedRows = 0;
+    for (const FrameDiff::Band& band : bands) {
+        const void* rows = packRows(data, width, band, pitch);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, band.firstRow, width, band.rows, glFormat, glType, rows);
+        uploadedRows += band.rows;
     }
 
+    size_t rowSize = (size_t) width * bytesPerPixel;
+    telemetry.recordUpload(false, uploadedRows * rowSize, uploadedRows < height);
+
     glBindTexture(GL_TEXTURE_2D, 0);
 
     Renderer::onNewFrame(data, width, height, pitch);
 }
 
-void ImageRendererES2::convertDataFromRGB8888(const void *data, size_t size) {
-    char* pixelData = (char*) data;
+// Returns the rows of the band tightly packed and in the texture format. Conversion and repacking
+// happen in a single pass into the staging buffer, RGB565 rows without padding are used as is.
+const void* ImageRendererES2::packRows(
+    const void *data,
+    unsigned int width,
+    const FrameDiff::Band& band,
+    size_t pitch
+) {
+    auto rows = static_cast<const uint8_t*>(data) + band.firstRow * pitch;
+    size_t rowSize = (size_t) width * bytesPerPixel;
+    if (conversion == PixelConversion::Type::COPY_16 && rowSize == pitch) {
+        return rows;
+    }
 
-    for (int i = 0; i < size - 4; i += 4) {
-        auto currentRed = pixelData[i + 0];
-        auto currentBlue = pixelData[i + 2];
-        pixelData[i + 0] = currentBlue;
-        pixelData[i + 2] = currentRed;
+    if (stagingBuffer.size() < rowSize * band.rows) {
+        stagingBuffer.resize(rowSize * band.rows);
     }
+
+    PixelConversion::convertRows(conversion, rows, pitch, stagingBuffer.data(), rowSize, width, band.rows);
+    return stagingBuffer.data();
 }
 
 uintptr_t ImageRendererES2::getTexture() {
@@ -82,6 +93,7 @@ uintptr_t ImageRendererES2::getFramebuffer() {
 
 void ImageRendererES2::setPixelFormat(int pixelFormat) {
     this->pixelFormat = pixelFormat;
+    frameDiff.invalidate();
 
     switch (pixelFormat) {
         case RETRO_PIXEL_FORMAT_XRGB8888:
@@ -89,6 +101,7 @@ void ImageRendererES2::setPixelFormat(int pixelFormat) {
             this->glFormat = GL_RGBA;
             this->glType = GL_UNSIGNED_BYTE;
             this->bytesPerPixel = 4;
+            this->conversion = PixelConversion::Type::SWAP_RED_BLUE_32;
             break;
 
         default:
@@ -98,20 +111,13 @@ void ImageRendererES2::setPixelFormat(int pixelFormat) {
             this->glFormat = GL_RGB;
             this->glType = GL_UNSIGNED_SHORT_5_6_5;
             this->bytesPerPixel = 2;
+            this->conversion = pixelFormat == RETRO_PIXEL_FORMAT_0RGB1555
+                ? PixelConversion::Type::RGB1555_TO_RGB565
+                : PixelConversion::Type::COPY_16;
             break;
     }
 }
 
-void ImageRendererES2::convertDataFrom0RGB1555(const void *data, unsigned int width, unsigned int height, size_t pitch) const {
-    auto castData = (uint16_t*) data;
-
-    for (int i = 0; i < height * pitch / bytesPerPixel; ++i) {
-         castData[i] = ((0x1Fu) & castData[i])
-            | (((0x1Fu << 5) & castData[i]) << 1)
-            | (((0x1Fu << 10) & castData[i]) << 1);
-    }
-}
-
 void ImageRendererES2::updateRenderedResolution(unsigned int width, unsigned int height) {}
 
 bool ImageRendererES2::rendersInVideoCallback() {
@@ -22,6 +22,9 @@
 
 #include "../renderer.h"
 #include "../../libretro-common/include/libretro.h"
+#include "../../utils/pixelconversion.h"
+#include "../../utils/framediff.h"
+#include "../../videotelemetry.h"
 
 #include <cstdint>
 #include <utility>
@@ -31,7 +34,7 @@ namespace libretrodroid {
 
 class ImageRendererES2: public Renderer {
 public:
-    explicit ImageRendererES2();
+    explicit ImageRendererES2(VideoTelemetry& telemetry);
     uintptr_t getTexture() override;
     uintptr_t getFramebuffer() override;
     void onNewFrame(const void *data, unsigned width, unsigned height, size_t pitch) override;
@@ -44,8 +47,7 @@ public:
     PassData getPassData(unsigned int layer) override;
 
 private:
-    void convertDataFromRGB8888(const void* pixelData, size_t size);
-    void convertDataFrom0RGB1555(const void *data, unsigned int width, unsigned int height, size_t pitch) const;
+    const void* packRows(const void *data, unsigned int width, const FrameDiff::Band& band, size_t pitch);
 
 private:
     int pixelFormat = RETRO_PIXEL_FORMAT_RGB565;
@@ -53,10 +55,20 @@ private:
     unsigned int glType = 0;
     unsigned int glInternalFormat = 0;
     unsigned int glFormat = 0;
+    PixelConversion::Type conversion = PixelConversion::Type::COPY_16;
 
     bool linear = false;
 
     unsigned int currentTexture = 0;
+
+    // Tightly packed copy of the frame in the texture format, reused across frames. ES2 has no
+    // GL_UNPACK_ROW_LENGTH, so padded frames would otherwise need one upload per row.
+    std::vector<uint8_t> stagingBuffer;
+
+    // Only rows which changed since the last frame are uploaded, identical frames are skipped.
+    FrameDiff frameDiff;
+
+    VideoTelemetry& telemetry;
 };
 
 }
@@ -58,6 +58,16 @@ void FramebufferRenderer::initializeBuffers() {
         depth,
         stencil
     );
+
+    applyPixelFormat();
+}
+
+// Cores render RGBA, but in the 32 bit format the fourth channel is unused and often left
+// undefined, so it is not sampled.
+void FramebufferRenderer::applyPixelFormat() {
+    glBindTexture(GL_TEXTURE_2D, framebuffer->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, pixelFormat == RETRO_PIXEL_FORMAT_XRGB8888 ? GL_ONE : GL_ALPHA);
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 uintptr_t FramebufferRenderer::getTexture() {
@@ -68,8 +78,11 @@ uintptr_t FramebufferRenderer::getFramebuffer() {
     return framebuffer->framebuffer;
 }
 
+// The color attachment stays RGBA8 for every format. Many hardware cores never set one and
+// would be stuck with the 0RGB1555 default, which is too coarse for 3D output.
 void FramebufferRenderer::setPixelFormat(int pixelFormat) {
-    // TODO... Here we should handle 32bit framebuffers.
+    this->pixelFormat = pixelFormat;
+    applyPixelFormat();
 }
 
 void FramebufferRenderer::updateRenderedResolution(unsigned int width, unsigned int height) {
@@ -23,6 +23,7 @@
 
 #include "../renderer.h"
 #include "es3utils.h"
+#include "../../libretro-common/include/libretro.h"
 
 namespace libretrodroid {
 
@@ -54,6 +55,7 @@ private:
     unsigned int height;
 
     bool isDirty = false;
+    int pixelFormat = RETRO_PIXEL_FORMAT_0RGB1555;
 
     std::unique_ptr<ES3Utils::Framebuffer> framebuffer = std::make_unique<ES3Utils::Framebuffer>();
 
@@ -61,6 +63,7 @@ private:
     std::unique_ptr<ES3Utils::Framebuffers> framebuffers = std::make_unique<ES3Utils::Framebuffers>();
 
     void initializeBuffers();
+    void applyPixelFormat();
 };
 
 }
@@ -18,58 +18,337 @@
 #include "imagerendereres3.h"
 #include "../../libretro-common/include/libretro.h"
 #include "es3utils.h"
+#include "../../log.h"
+
+#include <chrono>
 
 namespace libretrodroid {
 
-ImageRendererES3::ImageRendererES3() {
+// A fence still pending after this long most likely means a lost context, the frame then goes
+// through the synchronous path.
+static constexpr GLuint64 PIXEL_BUFFER_FENCE_TIMEOUT_NS = 100'000'000;
+
+// Draws one triangle covering the whole target, positions come from the vertex index.
+static const char* DECODE_VERTEX_SHADER = R"(#version 300 es
+    void main() {
+        vec2 position = vec2(float((gl_VertexID & 1) << 2), float((gl_VertexID & 2) << 1)) - 1.0;
+        gl_Position = vec4(position, 0.0, 1.0);
+    }
+)";
+
+// Unpacks raw 0RGB1555 pixels, the target has the frame size so fragments map to texels.
+static const char* DECODE_1555_FRAGMENT_SHADER = R"(#version 300 es
+    precision mediump float;
+    precision highp usampler2D;
+
+    uniform usampler2D source;
+    out vec4 fragColor;
+
+    void main() {
+        uint pixel = texelFetch(source, ivec2(gl_FragCoord.xy), 0).r;
+        vec3 color = vec3(uvec3(pixel >> 10, pixel >> 5, pixel) & 31u) / 31.0;
+        fragColor = vec4(color, 1.0);
+    }
+)";
+
+ImageRendererES3::ImageRendererES3(VideoTelemetry& telemetry) : telemetry(telemetry) {
     glGenTextures(1, &currentTexture);
     glBindTexture(GL_TEXTURE_2D, currentTexture);
 }
 
-void ImageRendererES3::onNewFrame(const void *data, unsigned width, unsigned height, size_t pitch) {
-    if (pixelFormat == RETRO_PIXEL_FORMAT_0RGB1555) {
-        convertDataFrom0RGB1555(data, width, height, pitch);
+// GL objects are released with the Video owning this renderer.
+ImageRendererES3::~ImageRendererES3() {
+    deletePixelBuffers();
+
+    if (decodeProgram != 0) {
+        glDeleteProgram(decodeProgram);
+    }
+    ES3Utils::deleteFramebuffer(std::move(decodeFramebuffer));
+
+    for (auto& framebuffer : *framebuffers) {
+        ES3Utils::deleteFramebuffer(std::move(framebuffer));
     }
 
+    glDeleteTextures(1, &currentTexture);
+}
+
+void ImageRendererES3::onNewFrame(const void *data, unsigned width, unsigned height, size_t pitch) {
     if (lastFrameSize.first != width || lastFrameSize.second != height || isDirty) {
         initializeTextures(width, height);
     }
 
+    const std::vector<FrameDiff::Band>& bands = frameDiff.update(data, width, height, pitch, bytesPerPixel);
+    if (bands.empty()) {
+        telemetry.recordSkippedUpload();
+        Renderer::onNewFrame(data, width, height, pitch);
+        return;
+    }
+
     glBindTexture(GL_TEXTURE_2D, currentTexture);
 
     glPixelStorei(GL_UNPACK_ALIGNMENT, bytesPerPixel);
-    glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch / bytesPerPixel);
 
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, glFormat, glType, data);
+    bool viaPixelBuffer = uploadWithPixelBuffer(data, width, height, pitch, bands);
+    if (!viaPixelBuffer) {
+        uploadDirectly(data, width, pitch, bands);
+    }
 
-    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    size_t rowSize = (size_t) width * bytesPerPixel;
+    size_t uploadedRows = 0;
+    for (const FrameDiff::Band& band : bands) {
+        uploadedRows += band.rows;
+    }
+    telemetry.recordUpload(viaPixelBuffer, uploadedRows * rowSize, uploadedRows < height);
 
     glBindTexture(GL_TEXTURE_2D, 0);
 
+    if (decodeOnGPU) {
+        decodeFrame(width, height);
+    }
+
     Renderer::onNewFrame(data, width, height, pitch);
 }
 
+void ImageRendererES3::decodeFrame(unsigned int width, unsigned int height) {
+    // Runs from onNewFrame, so the viewport of whatever pass comes next is left untouched.
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, decodeFramebuffer->framebuffer);
+    glViewport(0, 0, width, height);
+    glUseProgram(decodeProgram);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, currentTexture);
+    glUniform1i(decodeSourceHandle, 0);
+
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+bool ImageRendererES3::initializeDecodeProgram() {
+    if (decodeProgram != 0) {
+        return true;
+    }
+
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &DECODE_VERTEX_SHADER, nullptr);
+    glCompileShader(vertexShader);
+
+    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &DECODE_1555_FRAGMENT_SHADER, nullptr);
+    glCompileShader(fragmentShader);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus != GL_TRUE) {
+        LOGE("Cannot build the 0RGB1555 decode program, converting on the CPU");
+        glDeleteProgram(program);
+        return false;
+    }
+
+    decodeProgram = program;
+    decodeSourceHandle = glGetUniformLocation(program, "source");
+    return true;
+}
+
+// Uploads the changed rows from client memory. Frames which need a conversion go through the
+// staging buffer.
+void ImageRendererES3::uploadDirectly(
+    const void *data,
+    unsigned width,
+    size_t pitch,
+    const std::vector<FrameDiff::Band>& bands
+) {
+    auto source = static_cast<const uint8_t*>(data);
+    size_t rowSize = (size_t) width * bytesPerPixel;
+
+    if (conversion == PixelConversion::Type::COPY_16 || conversion == PixelConversion::Type::COPY_32) {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch / bytesPerPixel);
+        for (const FrameDiff::Band& band : bands) {
+            const uint8_t* rows = source + band.firstRow * pitch;
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, band.firstRow, width, band.rows, glFormat, glType, rows);
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        return;
+    }
+
+    for (const FrameDiff::Band& band : bands) {
+        if (stagingBuffer.size() < rowSize * band.rows) {
+            stagingBuffer.resize(rowSize * band.rows);
+        }
+
+        const uint8_t* rows = source + band.firstRow * pitch;
+        PixelConversion::convertRows(conversion, rows, pitch, stagingBuffer.data(), rowSize, width, band.rows);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, band.firstRow, width, band.rows, glFormat, glType, stagingBuffer.data());
+    }
+}
+
+// Copies the changed rows, tightly packed and converted, into the next pixel buffer and starts
+// the texture upload from it. Returns false when the frame still has to be uploaded from client
+// memory.
+bool ImageRendererES3::uploadWithPixelBuffer(
+    const void *data,
+    unsigned width,
+    unsigned height,
+    size_t pitch,
+    const std::vector<FrameDiff::Band>& bands
+) {
+    size_t rowSize = width * bytesPerPixel;
+    if (pixelBuffersFailed || rowSize * height > pixelBufferSize) {
+        return false;
+    }
+
+    size_t index = nextPixelBuffer;
+    GLsync& fence = pixelBufferFences[index];
+
+    if (fence != nullptr) {
+        // The buffer is mapped unsynchronized, so the GPU has to be done with the previous
+        // upload from it first.
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            auto start = std::chrono::steady_clock::now();
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, PIXEL_BUFFER_FENCE_TIMEOUT_NS);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            telemetry.recordFenceWait(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+
+        if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+            return false;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers[index]);
+
+    // Rows keep their position in the buffer, only the span covering the changed ones is mapped.
+    size_t mappedStart = bands.front().firstRow * rowSize;
+    size_t mappedEnd = (bands.back().firstRow + bands.back().rows) * rowSize;
+
+    auto mapped = static_cast<uint8_t*>(glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER,
+        mappedStart,
+        mappedEnd - mappedStart,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+    ));
+
+    if (mapped == nullptr) {
+        LOGE("Cannot map pixel buffer, falling back to direct texture uploads");
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        pixelBuffersFailed = true;
+        return false;
+    }
+
+    auto source = static_cast<const uint8_t*>(data);
+    for (const FrameDiff::Band& band : bands) {
+        PixelConversion::convertRows(
+            conversion,
+            source + band.firstRow * pitch,
+            pitch,
+            mapped + band.firstRow * rowSize - mappedStart,
+            rowSize,
+            width,
+            band.rows
+        );
+    }
+
+    // The content is undefined if the buffer got corrupted while mapped, this frame is simply
+    // uploaded again from client memory.
+    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+
+    for (const FrameDiff::Band& band : bands) {
+        auto offset = reinterpret_cast<const void*>(band.firstRow * rowSize);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, band.firstRow, width, band.rows, glFormat, glType, offset);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    nextPixelBuffer = (index + 1) % PIXEL_BUFFER_COUNT;
+    return true;
+}
+
+void ImageRendererES3::initializePixelBuffers(size_t size) {
+    if (size == pixelBufferSize) {
+        return;
+    }
+
+    deletePixelBuffers();
+
+    glGenBuffers(PIXEL_BUFFER_COUNT, pixelBuffers.data());
+    for (GLuint pixelBuffer : pixelBuffers) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    pixelBufferSize = size;
+    nextPixelBuffer = 0;
+}
+
+void ImageRendererES3::deletePixelBuffers() {
+    for (GLsync& fence : pixelBufferFences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    if (pixelBufferSize > 0) {
+        glDeleteBuffers(PIXEL_BUFFER_COUNT, pixelBuffers.data());
+        pixelBuffers.fill(0);
+        pixelBufferSize = 0;
+    }
+}
+
 void ImageRendererES3::initializeTextures(unsigned int width, unsigned int height) {
     for (auto& i : *framebuffers) {
         ES3Utils::deleteFramebuffer(std::move(i));
     }
     framebuffers = libretrodroid::ES3Utils::buildShaderPasses(width, height, shaders);
 
+    // Integer textures cannot be filtered, the decoded copy is filtered instead.
+    bool linear = shaders.linearTexture && !decodeOnGPU;
+
     glBindTexture(GL_TEXTURE_2D, currentTexture);
     glTexImage2D(GL_TEXTURE_2D, 0, glInternalFormat, width, height, 0, glFormat, glType, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, shaders.linearTexture ? GL_LINEAR : GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, shaders.linearTexture ? GL_LINEAR : GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, linear ? GL_LINEAR : GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, linear ? GL_LINEAR : GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+    // The X byte of XRGB8888 is undefined, alpha is forced to one.
     if (swapRedAndBlueChannels) {
-        applyGLSwizzle(GL_BLUE, GL_GREEN, GL_RED, GL_ALPHA);
+        applyGLSwizzle(GL_BLUE, GL_GREEN, GL_RED, GL_ONE);
     } else {
         applyGLSwizzle(GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA);
     }
 
     glBindTexture(GL_TEXTURE_2D, 0);
 
+    ES3Utils::deleteFramebuffer(std::move(decodeFramebuffer));
+    if (decodeOnGPU) {
+        decodeFramebuffer = ES3Utils::createFramebuffer(width, height, shaders.linearTexture, false, false, false);
+    }
+
+    initializePixelBuffers((size_t) width * height * bytesPerPixel);
+    frameDiff.invalidate();
+
     isDirty = false;
 }
 
@@ -81,7 +360,7 @@ void ImageRendererES3::applyGLSwizzle(int r, int g, int b, int a) {
 }
 
 uintptr_t ImageRendererES3::getTexture() {
-    return currentTexture;
+    return decodeOnGPU ? decodeFramebuffer->texture : currentTexture;
 }
 
 uintptr_t ImageRendererES3::getFramebuffer() {
@@ -99,28 +378,45 @@ void ImageRendererES3::setPixelFormat(int pixelFormat) {
             this->glType = GL_UNSIGNED_BYTE;
             this->bytesPerPixel = 4;
             this->swapRedAndBlueChannels = true;
+            this->conversion = PixelConversion::Type::COPY_32;
+            this->decodeOnGPU = false;
             break;
 
-        default:
+        // ES3 has no 1_5_5_5_REV type, frames are uploaded untouched as integers and unpacked
+        // by a shader pass. Conversion on the CPU is only a fallback.
         case RETRO_PIXEL_FORMAT_0RGB1555:
+            if (initializeDecodeProgram()) {
+                this->glInternalFormat = GL_R16UI;
+                this->glFormat = GL_RED_INTEGER;
+                this->glType = GL_UNSIGNED_SHORT;
+                this->bytesPerPixel = 2;
+                this->swapRedAndBlueChannels = false;
+                this->conversion = PixelConversion::Type::COPY_16;
+                this->decodeOnGPU = true;
+                break;
+            }
+            this->glInternalFormat = GL_RGB565;
+            this->glFormat = GL_RGB;
+            this->glType = GL_UNSIGNED_SHORT_5_6_5;
+            this->bytesPerPixel = 2;
+            this->swapRedAndBlueChannels = false;
+            this->conversion = PixelConversion::Type::RGB1555_TO_RGB565;
+            this->decodeOnGPU = false;
+            break;
+
+        default:
         case RETRO_PIXEL_FORMAT_RGB565:
             this->glInternalFormat = GL_RGB565;
             this->glFormat = GL_RGB;
             this->glType = GL_UNSIGNED_SHORT_5_6_5;
             this->bytesPerPixel = 2;
             this->swapRedAndBlueChannels = false;
+            this->conversion = PixelConversion::Type::COPY_16;
+            this->decodeOnGPU = false;
             break;
     }
-}
-
-void ImageRendererES3::convertDataFrom0RGB1555(const void *data, unsigned int width, unsigned int height, size_t pitch) const {
-    auto castData = (uint16_t*) data;
 
-    for (int i = 0; i < height * pitch / bytesPerPixel; ++i) {
-        castData[i] = ((0x1Fu) & castData[i])
-            | (((0x1Fu << 5) & castData[i]) << 1)
-            | (((0x1Fu << 10) & castData[i]) << 1);
-    }
+    this->isDirty = true;
 }
 
 void ImageRendererES3::updateRenderedResolution(unsigned int width, unsigned int height) {}
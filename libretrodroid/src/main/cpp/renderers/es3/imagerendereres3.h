@@ -21,9 +21,13 @@
 #include "../renderer.h"
 #include "../../libretro-common/include/libretro.h"
 #include "es3utils.h"
+#include "../../videotelemetry.h"
+#include "../../utils/pixelconversion.h"
+#include "../../utils/framediff.h"
 
 #include "GLES3/gl3.h"
 
+#include <array>
 #include <cstdint>
 #include <utility>
 #include <vector>
@@ -33,7 +37,8 @@ namespace libretrodroid {
 
 class ImageRendererES3: public Renderer {
 public:
-    explicit ImageRendererES3();
+    explicit ImageRendererES3(VideoTelemetry& telemetry);
+    ~ImageRendererES3() override;
     uintptr_t getTexture() override;
     uintptr_t getFramebuffer() override;
     void onNewFrame(const void *data, unsigned width, unsigned height, size_t pitch) override;
@@ -48,8 +53,19 @@ public:
 
 private:
     void initializeTextures(unsigned int width, unsigned int height);
+    void initializePixelBuffers(size_t size);
+    void deletePixelBuffers();
+    void uploadDirectly(const void *data, unsigned width, size_t pitch, const std::vector<FrameDiff::Band>& bands);
+    bool uploadWithPixelBuffer(
+        const void *data,
+        unsigned width,
+        unsigned height,
+        size_t pitch,
+        const std::vector<FrameDiff::Band>& bands
+    );
     void applyGLSwizzle(int r, int g, int b, int a);
-    void convertDataFrom0RGB1555(const void *data, unsigned int width, unsigned int height, size_t pitch) const;
+    bool initializeDecodeProgram();
+    void decodeFrame(unsigned int width, unsigned int height);
 
 private:
     int pixelFormat = RETRO_PIXEL_FORMAT_RGB565;
@@ -58,11 +74,36 @@ private:
     unsigned int glType = 0;
     unsigned int glInternalFormat = 0;
     unsigned int glFormat = 0;
+    PixelConversion::Type conversion = PixelConversion::Type::COPY_16;
+
+    // 0RGB1555 frames land in currentTexture as raw integers and are unpacked on the GPU into
+    // decodeFramebuffer, whose texture is the one handed to the shader chain.
+    bool decodeOnGPU = false;
+    GLuint decodeProgram = 0;
+    GLint decodeSourceHandle = -1;
+    std::unique_ptr<ES3Utils::Framebuffer> decodeFramebuffer;
 
     bool isDirty = true;
 
     unsigned int currentTexture = 0;
 
+    // Frames are copied into a ring of pixel buffers and the texture is filled from there, so
+    // the driver can transfer them asynchronously. A fence per buffer tells when the GPU is done
+    // reading it, and waiting on one only happens if the GPU is PIXEL_BUFFER_COUNT frames behind.
+    static constexpr size_t PIXEL_BUFFER_COUNT = 3;
+    std::array<GLuint, PIXEL_BUFFER_COUNT> pixelBuffers {};
+    std::array<GLsync, PIXEL_BUFFER_COUNT> pixelBufferFences {};
+    size_t pixelBufferSize = 0;
+    size_t nextPixelBuffer = 0;
+    bool pixelBuffersFailed = false;
+    VideoTelemetry& telemetry;
+
+    // Converted frames on the direct upload path.
+    std::vector<uint8_t> stagingBuffer;
+
+    // Only rows which changed since the last frame are uploaded, identical frames are skipped.
+    FrameDiff frameDiff;
+
     ShaderManager::Chain shaders;
     std::unique_ptr<ES3Utils::Framebuffers> framebuffers = std::make_unique<ES3Utils::Framebuffers>();
 };
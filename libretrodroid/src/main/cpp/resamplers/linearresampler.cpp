@@ -21,23 +21,80 @@
 
 namespace libretrodroid {
 
-void LinearResampler::resample(const int16_t *source, int32_t inputFrames, int16_t *sink, int32_t sinkFrames) {
-    double outputTime = 0;
-    double outputTimeStep = 1.0 / sinkFrames;
+inline const int16_t* LinearResampler::frameAt(const Input& input, int32_t index) const {
+    if (index < HISTORY_FRAMES) {
+        return &history[index * 2];
+    }
+    index -= HISTORY_FRAMES;
+    return index < input.firstFrames ? &input.first[index * 2] : &input.second[(index - input.firstFrames) * 2];
+}
+
+template <typename T>
+void LinearResampler::resampleInto(
+    const int16_t* first,
+    int32_t firstFrames,
+    const int16_t* second,
+    int32_t secondFrames,
+    T* sink,
+    int32_t sinkFrames
+) {
+    int32_t inputFrames = firstFrames + secondFrames;
+    if (inputFrames <= 0) {
+        std::fill(sink, sink + sinkFrames * 2, 0);
+        return;
+    }
 
-    double floatingPart, integerPart;
+    Input input { first, firstFrames, second };
+    double step = (double) inputFrames / sinkFrames;
+    int32_t lastFrame = inputFrames + HISTORY_FRAMES - 1;
 
     while (sinkFrames > 0) {
-        floatingPart = std::modf(outputTime * inputFrames, &integerPart);
+        auto floorFrame = (int32_t) position;
+        int32_t ceilFrame = std::min(floorFrame + 1, lastFrame);
+        auto floatingPart = (float) (position - floorFrame);
 
-        int32_t floorFrame = integerPart;
-        int32_t ceilFrame = std::min(floorFrame + 1, inputFrames - 1);
+        const int16_t* floorSample = frameAt(input, floorFrame);
+        const int16_t* ceilSample = frameAt(input, ceilFrame);
 
-        *sink++ = source[ceilFrame * 2] * (floatingPart) + source[floorFrame * 2] * (1.0 - floatingPart);
-        *sink++ = source[ceilFrame * 2 + 1] * (floatingPart) + source[floorFrame * 2 + 1] * (1.0 - floatingPart);
-        outputTime += outputTimeStep;
+        storeFrame(
+            sink,
+            floorSample[0] + (ceilSample[0] - floorSample[0]) * floatingPart,
+            floorSample[1] + (ceilSample[1] - floorSample[1]) * floatingPart
+        );
+        position += step;
         sinkFrames--;
     }
+
+    // Exactly inputFrames were consumed, up to rounding errors which must not accumulate.
+    position = std::clamp(position - inputFrames, 0.0, std::nextafter(1.0, 0.0));
+
+    for (int32_t i = 0; i < HISTORY_FRAMES; i++) {
+        const int16_t* frame = frameAt(input, inputFrames + i);
+        history[i * 2] = frame[0];
+        history[i * 2 + 1] = frame[1];
+    }
+}
+
+void LinearResampler::resample(
+    const int16_t* first,
+    int32_t firstFrames,
+    const int16_t* second,
+    int32_t secondFrames,
+    int16_t* sink,
+    int32_t sinkFrames
+) {
+    resampleInto(first, firstFrames, second, secondFrames, sink, sinkFrames);
+}
+
+void LinearResampler::resample(
+    const int16_t* first,
+    int32_t firstFrames,
+    const int16_t* second,
+    int32_t secondFrames,
+    float* sink,
+    int32_t sinkFrames
+) {
+    resampleInto(first, firstFrames, second, secondFrames, sink, sinkFrames);
 }
 
 } //namespace libretrodroid
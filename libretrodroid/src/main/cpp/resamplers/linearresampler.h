@@ -18,15 +18,61 @@
 #ifndef LIBRETRODROID_LINEARRESAMPLER_H
 #define LIBRETRODROID_LINEARRESAMPLER_H
 
+#include <cstdint>
+
 #include "resampler.h"
 
 namespace libretrodroid {
 
+// Streaming linear interpolation. Output is delayed by HISTORY_FRAMES input frames.
 class LinearResampler : public Resampler {
 public:
-    void resample(const int16_t *source, int32_t inputFrames, int16_t *sink, int32_t sinkFrames) override;
+    static constexpr int32_t HISTORY_FRAMES = 2;
+
+    using Resampler::resample;
+    void resample(
+        const int16_t* first,
+        int32_t firstFrames,
+        const int16_t* second,
+        int32_t secondFrames,
+        int16_t* sink,
+        int32_t sinkFrames
+    ) override;
+    void resample(
+        const int16_t* first,
+        int32_t firstFrames,
+        const int16_t* second,
+        int32_t secondFrames,
+        float* sink,
+        int32_t sinkFrames
+    ) override;
     LinearResampler() = default;
     virtual ~LinearResampler() = default;
+
+private:
+    struct Input {
+        const int16_t* first;
+        int32_t firstFrames;
+        const int16_t* second;
+    };
+
+    template <typename T>
+    void resampleInto(
+        const int16_t* first,
+        int32_t firstFrames,
+        const int16_t* second,
+        int32_t secondFrames,
+        T* sink,
+        int32_t sinkFrames
+    );
+    const int16_t* frameAt(const Input& input, int32_t index) const;
+
+private:
+    // Calls are treated as one continuous stream. The last frames of the previous call are kept
+    // so the interpolation can cross the callback edge, and position is the fractional read
+    // offset into history followed by the current input.
+    double position = 0.0;
+    int16_t history[HISTORY_FRAMES * 2] = {};
 };
 
 } //namespace libretrodroid
@@ -0,0 +1,267 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "polyphaseresampler.h"
+
+namespace libretrodroid {
+
+static constexpr double PI = 3.14159265358979323846;
+
+// Zeroth order modified Bessel function of the first kind, used by the Kaiser window.
+static double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    double halfX = x / 2.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1.0e-12) break;
+    }
+    return sum;
+}
+
+// Filters one frame. Coefficients for the fractional position are interpolated on the fly from
+// the two closest phases, both channels share them.
+static inline void filterFrame(
+    const float* left,
+    const float* right,
+    const float* coefficients,
+    const float* deltas,
+    float fraction,
+    float* outLeft,
+    float* outRight
+) {
+#if defined(__ARM_NEON)
+    float32x4_t accLeft = vdupq_n_f32(0.0f);
+    float32x4_t accRight = vdupq_n_f32(0.0f);
+    float32x4_t fractionVector = vdupq_n_f32(fraction);
+
+    for (int32_t i = 0; i < PolyphaseResampler::TAPS; i += 4) {
+        float32x4_t coefficient = vmlaq_f32(vld1q_f32(coefficients + i), vld1q_f32(deltas + i), fractionVector);
+        accLeft = vmlaq_f32(accLeft, vld1q_f32(left + i), coefficient);
+        accRight = vmlaq_f32(accRight, vld1q_f32(right + i), coefficient);
+    }
+
+    float32x2_t sumLeft = vadd_f32(vget_low_f32(accLeft), vget_high_f32(accLeft));
+    float32x2_t sumRight = vadd_f32(vget_low_f32(accRight), vget_high_f32(accRight));
+    *outLeft = vget_lane_f32(vpadd_f32(sumLeft, sumLeft), 0);
+    *outRight = vget_lane_f32(vpadd_f32(sumRight, sumRight), 0);
+#elif defined(__SSE2__)
+    __m128 accLeft = _mm_setzero_ps();
+    __m128 accRight = _mm_setzero_ps();
+    __m128 fractionVector = _mm_set1_ps(fraction);
+
+    for (int32_t i = 0; i < PolyphaseResampler::TAPS; i += 4) {
+        __m128 coefficient = _mm_add_ps(
+            _mm_loadu_ps(coefficients + i),
+            _mm_mul_ps(_mm_loadu_ps(deltas + i), fractionVector)
+        );
+        accLeft = _mm_add_ps(accLeft, _mm_mul_ps(_mm_loadu_ps(left + i), coefficient));
+        accRight = _mm_add_ps(accRight, _mm_mul_ps(_mm_loadu_ps(right + i), coefficient));
+    }
+
+    // Horizontal sums of both accumulators at once.
+    __m128 low = _mm_unpacklo_ps(accLeft, accRight);
+    __m128 high = _mm_unpackhi_ps(accLeft, accRight);
+    __m128 pairs = _mm_add_ps(low, high);
+    __m128 sums = _mm_add_ps(pairs, _mm_movehl_ps(pairs, pairs));
+    *outLeft = _mm_cvtss_f32(sums);
+    *outRight = _mm_cvtss_f32(_mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 1, 1, 1)));
+#else
+    float accLeft = 0.0f;
+    float accRight = 0.0f;
+    for (int32_t i = 0; i < PolyphaseResampler::TAPS; i++) {
+        float coefficient = coefficients[i] + deltas[i] * fraction;
+        accLeft += left[i] * coefficient;
+        accRight += right[i] * coefficient;
+    }
+    *outLeft = accLeft;
+    *outRight = accRight;
+#endif
+}
+
+PolyphaseResampler::PolyphaseResampler() {
+    coefficients.assign(CUTOFF_LEVELS * TABLE_SIZE, 0.0f);
+    deltas.assign(CUTOFF_LEVELS * TABLE_SIZE, 0.0f);
+
+    for (int32_t level = 0; level < CUTOFF_LEVELS; level++) {
+        buildTables(level, CUTOFF * std::exp2(-(float) level / CUTOFF_LEVELS_PER_OCTAVE));
+    }
+
+    ensureCapacity(DEFAULT_CAPACITY_FRAMES);
+}
+
+void PolyphaseResampler::reserve(int32_t maxInputFrames) {
+    ensureCapacity(maxInputFrames);
+}
+
+void PolyphaseResampler::buildTables(int32_t level, float cutoff) {
+    float* levelCoefficients = &coefficients[level * TABLE_SIZE];
+    float* levelDeltas = &deltas[level * TABLE_SIZE];
+
+    double windowNormalization = besselI0(KAISER_BETA);
+
+    for (int32_t phase = 0; phase <= PHASES; phase++) {
+        double fraction = (double) phase / PHASES;
+        float* row = &levelCoefficients[phase * TAPS];
+
+        double sum = 0.0;
+        for (int32_t tap = 0; tap < TAPS; tap++) {
+            // Distance of this tap from the output position, in input frames.
+            double x = (tap - HALF_TAPS + 1) - fraction;
+
+            double sinc = x == 0.0 ? 1.0 : std::sin(PI * cutoff * x) / (PI * cutoff * x);
+
+            double windowPosition = x / HALF_TAPS;
+            double window = 0.0;
+            if (std::abs(windowPosition) < 1.0) {
+                window = besselI0(KAISER_BETA * std::sqrt(1.0 - windowPosition * windowPosition)) / windowNormalization;
+            }
+
+            row[tap] = (float) (sinc * window);
+            sum += row[tap];
+        }
+
+        // Unity gain at DC for every phase, otherwise the phase interpolation becomes audible.
+        for (int32_t tap = 0; tap < TAPS; tap++) {
+            row[tap] = (float) (row[tap] / sum);
+        }
+    }
+
+    for (int32_t phase = 0; phase < PHASES; phase++) {
+        for (int32_t tap = 0; tap < TAPS; tap++) {
+            levelDeltas[phase * TAPS + tap] =
+                levelCoefficients[(phase + 1) * TAPS + tap] - levelCoefficients[phase * TAPS + tap];
+        }
+    }
+}
+
+// Picks the table whose cutoff is closest below the output Nyquist frequency. A quarter of a
+// level of slack keeps the small adjustments of the rate controller on the full band table.
+int32_t PolyphaseResampler::findCutoffLevel(double step) {
+    if (step <= 1.0) {
+        return 0;
+    }
+
+    double level = std::ceil(std::log2(step) * CUTOFF_LEVELS_PER_OCTAVE - 0.25);
+    return std::clamp((int32_t) level, 0, CUTOFF_LEVELS - 1);
+}
+
+void PolyphaseResampler::ensureCapacity(int32_t inputFrames) {
+    size_t required = HISTORY_FRAMES + inputFrames;
+    if (left.size() < required) {
+        left.resize(required, 0.0f);
+        right.resize(required, 0.0f);
+    }
+}
+
+template <typename T>
+void PolyphaseResampler::resampleInto(
+    const int16_t* first,
+    int32_t firstFrames,
+    const int16_t* second,
+    int32_t secondFrames,
+    T* sink,
+    int32_t sinkFrames
+) {
+    int32_t inputFrames = firstFrames + secondFrames;
+    if (sinkFrames <= 0) {
+        return;
+    }
+
+    if (inputFrames <= 0) {
+        std::fill(sink, sink + sinkFrames * 2, 0);
+        return;
+    }
+
+    double step = (double) inputFrames / sinkFrames;
+    size_t table = (size_t) findCutoffLevel(step) * TABLE_SIZE;
+
+    // Only grows when reserve did not cover this input.
+    ensureCapacity(inputFrames);
+
+    for (int32_t i = 0; i < firstFrames; i++) {
+        left[HISTORY_FRAMES + i] = first[i * 2];
+        right[HISTORY_FRAMES + i] = first[i * 2 + 1];
+    }
+    for (int32_t i = 0; i < secondFrames; i++) {
+        left[HISTORY_FRAMES + firstFrames + i] = second[i * 2];
+        right[HISTORY_FRAMES + firstFrames + i] = second[i * 2 + 1];
+    }
+
+    // The first output sits HALF_TAPS frames before the first new input frame, the last one
+    // step frames before the end of the input, so all the taps always fall inside the buffer.
+    double position = HALF_TAPS - 1;
+    for (int32_t i = 0; i < sinkFrames; i++) {
+        int32_t frame = (int32_t) position;
+        float phasePosition = (float) ((position - frame) * PHASES);
+        int32_t phase = std::min((int32_t) phasePosition, PHASES - 1);
+        float fraction = phasePosition - phase;
+
+        float outLeft;
+        float outRight;
+        filterFrame(
+            &left[frame - HALF_TAPS + 1],
+            &right[frame - HALF_TAPS + 1],
+            &coefficients[table + phase * TAPS],
+            &deltas[table + phase * TAPS],
+            fraction,
+            &outLeft,
+            &outRight
+        );
+
+        storeFrame(sink, outLeft, outRight);
+
+        position += step;
+    }
+
+    std::copy(left.begin() + inputFrames, left.begin() + inputFrames + HISTORY_FRAMES, left.begin());
+    std::copy(right.begin() + inputFrames, right.begin() + inputFrames + HISTORY_FRAMES, right.begin());
+}
+
+void PolyphaseResampler::resample(
+    const int16_t* first,
+    int32_t firstFrames,
+    const int16_t* second,
+    int32_t secondFrames,
+    int16_t* sink,
+    int32_t sinkFrames
+) {
+    resampleInto(first, firstFrames, second, secondFrames, sink, sinkFrames);
+}
+
+void PolyphaseResampler::resample(
+    const int16_t* first,
+    int32_t firstFrames,
+    const int16_t* second,
+    int32_t secondFrames,
+    float* sink,
+    int32_t sinkFrames
+) {
+    resampleInto(first, firstFrames, second, secondFrames, sink, sinkFrames);
+}
+
+} //namespace libretrodroid
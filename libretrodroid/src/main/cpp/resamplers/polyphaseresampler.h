@@ -0,0 +1,104 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_POLYPHASERESAMPLER_H
+#define LIBRETRODROID_POLYPHASERESAMPLER_H
+
+#include <vector>
+
+#include "resampler.h"
+
+namespace libretrodroid {
+
+// Kaiser windowed sinc resampler. The filter is evaluated from precomputed phase tables,
+// linearly interpolated between neighbouring phases, instead of calling sinf per tap.
+// Tables for every cutoff it can need are built up front, so the audio thread never computes
+// coefficients nor allocates.
+// The last TAPS - 1 input frames are kept between calls, so the filter runs over one continuous
+// signal instead of restarting at every buffer boundary. This delays the output by HALF_TAPS
+// input frames.
+class PolyphaseResampler : public Resampler {
+public:
+    static constexpr int32_t TAPS = 32;
+    static constexpr int32_t HALF_TAPS = TAPS / 2;
+    static constexpr int32_t PHASES = 128;
+
+    PolyphaseResampler();
+    ~PolyphaseResampler() override = default;
+
+    // Sizes the history for the largest input of a single call. Not real-time safe.
+    void reserve(int32_t maxInputFrames);
+
+    using Resampler::resample;
+    void resample(
+        const int16_t* first,
+        int32_t firstFrames,
+        const int16_t* second,
+        int32_t secondFrames,
+        int16_t* sink,
+        int32_t sinkFrames
+    ) override;
+    void resample(
+        const int16_t* first,
+        int32_t firstFrames,
+        const int16_t* second,
+        int32_t secondFrames,
+        float* sink,
+        int32_t sinkFrames
+    ) override;
+
+private:
+    template <typename T>
+    void resampleInto(
+        const int16_t* first,
+        int32_t firstFrames,
+        const int16_t* second,
+        int32_t secondFrames,
+        T* sink,
+        int32_t sinkFrames
+    );
+    void buildTables(int32_t level, float cutoff);
+    static int32_t findCutoffLevel(double step);
+    void ensureCapacity(int32_t inputFrames);
+
+private:
+    // Fraction of the Nyquist frequency which is kept, leaves room for the transition band.
+    static constexpr float CUTOFF = 0.90f;
+    static constexpr float KAISER_BETA = 8.0f;
+    static constexpr int32_t HISTORY_FRAMES = TAPS - 1;
+    static constexpr int32_t DEFAULT_CAPACITY_FRAMES = 4096;
+
+    // When the input is faster than the output the cutoff follows the output Nyquist frequency.
+    // Cutoffs are quantized in quarter octaves, down to an eighth of the full band, which covers
+    // fast-forward up to 8x.
+    static constexpr int32_t CUTOFF_LEVELS_PER_OCTAVE = 4;
+    static constexpr int32_t CUTOFF_LEVELS = 3 * CUTOFF_LEVELS_PER_OCTAVE + 1;
+    static constexpr int32_t TABLE_SIZE = (PHASES + 1) * TAPS;
+
+    // For each cutoff level, PHASES + 1 rows of TAPS coefficients and the difference to the
+    // next row.
+    std::vector<float> coefficients;
+    std::vector<float> deltas;
+
+    // Planar history followed by the current input.
+    std::vector<float> left;
+    std::vector<float> right;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_POLYPHASERESAMPLER_H
@@ -18,14 +18,59 @@
 #ifndef LIBRETRODROID_RESAMPLER_H
 #define LIBRETRODROID_RESAMPLER_H
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 
 namespace libretrodroid {
 
 class Resampler {
 public:
-    virtual void resample(const int16_t* source, int32_t inputFrames, int16_t* sink, int32_t sinkFrames) = 0;
+    // The input may be split in two segments, as handed out by a ring buffer. The second one
+    // continues the first one and can be empty.
+    virtual void resample(
+        const int16_t* first,
+        int32_t firstFrames,
+        const int16_t* second,
+        int32_t secondFrames,
+        int16_t* sink,
+        int32_t sinkFrames
+    ) = 0;
+
+    // Same as above, for float streams. Samples are scaled to [-1, 1] but not clamped.
+    virtual void resample(
+        const int16_t* first,
+        int32_t firstFrames,
+        const int16_t* second,
+        int32_t secondFrames,
+        float* sink,
+        int32_t sinkFrames
+    ) = 0;
+
+    void resample(const int16_t* source, int32_t inputFrames, int16_t* sink, int32_t sinkFrames) {
+        resample(source, inputFrames, nullptr, 0, sink, sinkFrames);
+    }
+
+    void resample(const int16_t* source, int32_t inputFrames, float* sink, int32_t sinkFrames) {
+        resample(source, inputFrames, nullptr, 0, sink, sinkFrames);
+    }
+
     virtual ~Resampler() = default;
+
+protected:
+    // Resamplers compute in the int16 range, the conversion to the output format happens once
+    // when a frame is stored.
+    static inline void storeFrame(int16_t*& sink, float left, float right) {
+        *sink++ = (int16_t) std::clamp(std::lrint(left), -32768L, 32767L);
+        *sink++ = (int16_t) std::clamp(std::lrint(right), -32768L, 32767L);
+    }
+
+    static inline void storeFrame(float*& sink, float left, float right) {
+        *sink++ = left * INT16_TO_FLOAT;
+        *sink++ = right * INT16_TO_FLOAT;
+    }
+
+    static constexpr float INT16_TO_FLOAT = 1.0f / 32768.0f;
 };
 }
 
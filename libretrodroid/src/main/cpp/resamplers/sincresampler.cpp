@@ -23,7 +23,16 @@ namespace libretrodroid {
 SincResampler::SincResampler(const int taps)
     : halfTaps(taps / 2) { }
 
-void SincResampler::resample(const int16_t *source, int32_t inputFrames, int16_t *sink, int32_t sinkFrames) {
+template <typename T>
+void SincResampler::resampleInto(
+    const int16_t* first,
+    int32_t firstFrames,
+    const int16_t* second,
+    int32_t secondFrames,
+    T* sink,
+    int32_t sinkFrames
+) {
+    int32_t inputFrames = firstFrames + secondFrames;
     double outputTime = 0;
     double outputTimeStep = 1.0f / sinkFrames;
 
@@ -40,13 +49,15 @@ void SincResampler::resample(const int16_t *source, int32_t inputFrames, int16_t
         for (int32_t currentInputIndex = startFrame; currentInputIndex <= endFrame; currentInputIndex++) {
             float sincCoefficient = sinc(outputTime * inputFrames - currentInputIndex);
             gain += sincCoefficient;
-            leftResult += source[currentInputIndex * 2] * sincCoefficient;
-            rightResult += source[currentInputIndex * 2 + 1] * sincCoefficient;
+            const int16_t* frame = currentInputIndex < firstFrames
+                ? &first[currentInputIndex * 2]
+                : &second[(currentInputIndex - firstFrames) * 2];
+            leftResult += frame[0] * sincCoefficient;
+            rightResult += frame[1] * sincCoefficient;
         }
 
         outputTime += outputTimeStep;
-        *sink++ = leftResult / gain;
-        *sink++ = rightResult / gain;
+        storeFrame(sink, (float) (leftResult / gain), (float) (rightResult / gain));
         sinkFrames--;
     }
 }
@@ -56,4 +67,26 @@ float SincResampler::sinc(float x) {
     return sinf(x * PI_F) / (x * PI_F);
 }
 
+void SincResampler::resample(
+    const int16_t* first,
+    int32_t firstFrames,
+    const int16_t* second,
+    int32_t secondFrames,
+    int16_t* sink,
+    int32_t sinkFrames
+) {
+    resampleInto(first, firstFrames, second, secondFrames, sink, sinkFrames);
+}
+
+void SincResampler::resample(
+    const int16_t* first,
+    int32_t firstFrames,
+    const int16_t* second,
+    int32_t secondFrames,
+    float* sink,
+    int32_t sinkFrames
+) {
+    resampleInto(first, firstFrames, second, secondFrames, sink, sinkFrames);
+}
+
 } //namespace libretrodroid
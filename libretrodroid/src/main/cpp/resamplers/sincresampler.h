@@ -24,11 +24,36 @@ namespace libretrodroid {
 
 class SincResampler : public Resampler {
 public:
-    void resample(const int16_t *source, int32_t inputFrames, int16_t *sink, int32_t sinkFrames) override;
+    using Resampler::resample;
+    void resample(
+        const int16_t* first,
+        int32_t firstFrames,
+        const int16_t* second,
+        int32_t secondFrames,
+        int16_t* sink,
+        int32_t sinkFrames
+    ) override;
+    void resample(
+        const int16_t* first,
+        int32_t firstFrames,
+        const int16_t* second,
+        int32_t secondFrames,
+        float* sink,
+        int32_t sinkFrames
+    ) override;
     SincResampler(const int taps);
     ~SincResampler() = default;
 
 private:
+    template <typename T>
+    void resampleInto(
+        const int16_t* first,
+        int32_t firstFrames,
+        const int16_t* second,
+        int32_t secondFrames,
+        T* sink,
+        int32_t sinkFrames
+    );
     static float sinc(float x);
 
 private:
@@ -0,0 +1,139 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "timestretcher.h"
+
+namespace libretrodroid {
+
+TimeStretcher::TimeStretcher(int32_t sampleRate) {
+    // 20ms segments joined over 5ms, searched over +/- 5ms.
+    segmentFrames = std::max(sampleRate / 50, 64);
+    overlapFrames = segmentFrames / 4;
+    searchFrames = segmentFrames / 4;
+
+    overlap.resize(overlapFrames * 2);
+    overlapMono.resize(overlapFrames);
+}
+
+void TimeStretcher::reset() {
+    inputFrames = 0;
+    position = 0.0;
+    hasOverlap = false;
+}
+
+std::pair<const int16_t*, size_t> TimeStretcher::process(const int16_t* data, size_t frames, double speed) {
+    size_t required = (inputFrames + frames) * 2;
+    if (input.size() < required) {
+        input.resize(required);
+    }
+    memcpy(&input[inputFrames * 2], data, frames * 2 * sizeof(int16_t));
+    inputFrames += frames;
+
+    outputFrames = 0;
+
+    while (true) {
+        auto nominal = (size_t) position;
+        if (nominal + searchFrames + segmentFrames + overlapFrames > inputFrames) {
+            break;
+        }
+
+        emitSegment(hasOverlap ? findBestOffset(nominal) : nominal);
+        position += segmentFrames * std::max(speed, 1.0);
+    }
+
+    compactInput();
+    return { output.data(), outputFrames };
+}
+
+// Normalized cross correlation of the mono downmix, every other frame is enough to find the
+// alignment and halves the cost.
+size_t TimeStretcher::findBestOffset(size_t nominal) const {
+    size_t first = nominal >= searchFrames ? nominal - searchFrames : 0;
+    size_t last = nominal + searchFrames;
+
+    size_t best = nominal;
+    float bestScore = -INFINITY;
+
+    for (size_t candidate = first; candidate <= last; candidate++) {
+        const int16_t* frames = &input[candidate * 2];
+        float correlation = 0.0f;
+        float energy = 1.0f;
+        for (size_t i = 0; i < overlapFrames; i += 2) {
+            float sample = (float) frames[i * 2] + (float) frames[i * 2 + 1];
+            correlation += sample * overlapMono[i];
+            energy += sample * sample;
+        }
+
+        float score = correlation / std::sqrt(energy);
+        if (score > bestScore) {
+            bestScore = score;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+void TimeStretcher::emitSegment(size_t start) {
+    size_t required = (outputFrames + segmentFrames) * 2;
+    if (output.size() < required) {
+        output.resize(required);
+    }
+
+    const int16_t* source = &input[start * 2];
+    int16_t* sink = &output[outputFrames * 2];
+
+    size_t copyStart = 0;
+    if (hasOverlap) {
+        for (size_t i = 0; i < overlapFrames; i++) {
+            float fadeIn = (float) (i + 1) / (float) (overlapFrames + 1);
+            float fadeOut = 1.0f - fadeIn;
+            sink[i * 2] = (int16_t) std::lrint(overlap[i * 2] * fadeOut + source[i * 2] * fadeIn);
+            sink[i * 2 + 1] = (int16_t) std::lrint(overlap[i * 2 + 1] * fadeOut + source[i * 2 + 1] * fadeIn);
+        }
+        copyStart = overlapFrames;
+    }
+
+    memcpy(&sink[copyStart * 2], &source[copyStart * 2], (segmentFrames - copyStart) * 2 * sizeof(int16_t));
+    outputFrames += segmentFrames;
+
+    const int16_t* continuation = &source[segmentFrames * 2];
+    for (size_t i = 0; i < overlapFrames; i++) {
+        overlap[i * 2] = continuation[i * 2];
+        overlap[i * 2 + 1] = continuation[i * 2 + 1];
+        overlapMono[i] = (float) continuation[i * 2] + (float) continuation[i * 2 + 1];
+    }
+    hasOverlap = true;
+}
+
+// Drops the input which can no longer be reached by the search window.
+void TimeStretcher::compactInput() {
+    auto nominal = (size_t) position;
+    size_t discard = std::min(nominal > searchFrames ? nominal - searchFrames : 0, inputFrames);
+    if (discard == 0) {
+        return;
+    }
+
+    memmove(&input[0], &input[discard * 2], (inputFrames - discard) * 2 * sizeof(int16_t));
+    inputFrames -= discard;
+    position -= (double) discard;
+}
+
+} //namespace libretrodroid
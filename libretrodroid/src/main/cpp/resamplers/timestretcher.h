@@ -0,0 +1,68 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_TIMESTRETCHER_H
+#define LIBRETRODROID_TIMESTRETCHER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace libretrodroid {
+
+// WSOLA time compression for fast-forward. Fixed length segments are taken from the input every
+// segment * speed frames and joined with a short crossfade. Each segment start is moved within a
+// small search window to where it best matches the natural continuation of the previous one,
+// so the pitch is kept and the joins don't produce audible beating.
+class TimeStretcher {
+public:
+    explicit TimeStretcher(int32_t sampleRate);
+
+    // Returns the compressed stereo frames, valid until the next call. Input which does not fill
+    // a whole segment yet is kept for the next call.
+    std::pair<const int16_t*, size_t> process(const int16_t* data, size_t frames, double speed);
+
+    void reset();
+
+private:
+    size_t findBestOffset(size_t nominal) const;
+    void emitSegment(size_t start);
+    void compactInput();
+
+private:
+    size_t segmentFrames;
+    size_t overlapFrames;
+    size_t searchFrames;
+
+    // Interleaved input not consumed yet, position is where the next segment nominally starts.
+    std::vector<int16_t> input;
+    size_t inputFrames = 0;
+    double position = 0.0;
+
+    // The frames which followed the last emitted segment, the next one fades in against them.
+    std::vector<float> overlap;
+    std::vector<float> overlapMono;
+    bool hasOverlap = false;
+
+    std::vector<int16_t> output;
+    size_t outputFrames = 0;
+};
+
+} //namespace libretrodroid
+
+#endif //LIBRETRODROID_TIMESTRETCHER_H
@@ -17,53 +17,463 @@
 
 #include "rewindbuffer.h"
 #include <algorithm>
+#include <cstring>
 
 namespace libretrodroid {
 
-RewindBuffer::RewindBuffer(size_t slotCount, size_t maxStateSize) : capacity(slotCount) {
-    slots.resize(slotCount);
-    for (auto& slot : slots) {
-        slot.reserve(maxStateSize);
+// In DELTA mode history is bounded by the byte budget. The entry table still needs a fixed size,
+// this caps it to a generous multiple of slotCount so tiny deltas can't grow it without bound.
+static constexpr size_t MAX_DELTA_HISTORY_FACTOR = 64;
+
+// Equal runs shorter than this are cheaper to store verbatim than to split the literal.
+static constexpr size_t MIN_SKIP_RUN = 8;
+
+// Two varints of at most 10 bytes each.
+static constexpr size_t MAX_RUN_HEADER_SIZE = 20;
+
+static size_t writeVarint(uint8_t* out, size_t value) {
+    size_t written = 0;
+    while (value >= 0x80) {
+        out[written++] = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    out[written++] = (uint8_t) value;
+    return written;
+}
+
+// Returns the number of bytes read, or 0 when the input ends early or the value does not fit in
+// a size_t.
+static size_t readVarint(const uint8_t* in, size_t available, size_t* value) {
+    constexpr unsigned BITS = sizeof(size_t) * 8;
+
+    size_t result = 0;
+    size_t read = 0;
+    unsigned shift = 0;
+    while (read < available && shift < BITS) {
+        uint8_t byte = in[read++];
+        size_t bits = byte & 0x7F;
+        if (shift > 0 && (bits >> (BITS - shift)) != 0) {
+            return 0;
+        }
+        result |= bits << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return read;
+        }
+        shift += 7;
+    }
+    return 0;
+}
+
+static inline bool equalWords(const uint8_t* a, const uint8_t* b) {
+    uint64_t x, y;
+    memcpy(&x, a, sizeof(x));
+    memcpy(&y, b, sizeof(y));
+    return x == y;
+}
+
+RewindBuffer::RewindBuffer(
+    size_t slotCount,
+    size_t maxStateSize,
+    Mode mode,
+    size_t budgetBytes,
+    RewindCodec::Type codecType
+) : mode(mode), maxStateSize(maxStateSize), capacity(slotCount), codec(codecType) {
+
+    if (budgetBytes == 0) {
+        budgetBytes = slotCount * maxStateSize;
+    }
+
+    if (mode == Mode::FULL) {
+        entries.resize(slotCount);
+    } else if (slotCount > 0) {
+        // The newest state lives outside of the ring, so it is taken out of the budget.
+        budgetBytes -= std::min(budgetBytes, maxStateSize);
+        entries.resize(slotCount * MAX_DELTA_HISTORY_FACTOR);
+        capacity = entries.size() + 1;
+        latestState.resize(maxStateSize);
+        encodeBuffer.resize(maxStateSize);
     }
+
+    storage = std::unique_ptr<uint8_t[]>(new uint8_t[budgetBytes]);
+    storageSize = budgetBytes;
+
+    if (!storesInPlace()) {
+        pendingState.resize(maxStateSize);
+    }
+
+    if (codec.getType() != RewindCodec::Type::NONE) {
+        compressBuffer.resize(maxStateSize);
+    }
+
+    publishStats();
 }
 
 RewindBuffer::~RewindBuffer() {
     clear();
 }
 
+float RewindBuffer::getUsage() const {
+    // States can be limited either by count or by bytes, report whichever is closer.
+    float slotUsage = capacity > 0 ? (float) getValidCount() / (float) capacity : 0.0f;
+
+    size_t capacityBytes = getCapacityBytes();
+    float byteUsage = capacityBytes > 0 ? (float) getUsedBytes() / (float) capacityBytes : 0.0f;
+
+    return std::min(std::max(slotUsage, byteUsage), 1.0f);
+}
+
+void RewindBuffer::publishStats() {
+    publishedValidCount.store(validCount(), std::memory_order_relaxed);
+    publishedUsedBytes.store(usedBytes, std::memory_order_relaxed);
+    publishedCapacityBytes.store(storageSize + latestState.size(), std::memory_order_relaxed);
+}
+
+// Uncompressed full states are serialized directly into the ring.
+bool RewindBuffer::storesInPlace() const {
+    return mode == Mode::FULL && codec.getType() == RewindCodec::Type::NONE;
+}
+
 void RewindBuffer::push(const uint8_t* data, size_t size) {
-    auto& slot = slots[writeIndex];
-    slot.resize(size);
-    std::copy(data, data + size, slot.begin());
+    uint8_t* target = beginPush(size);
+    if (target == nullptr) {
+        return;
+    }
 
-    writeIndex = (writeIndex + 1) % capacity;
-    if (validCount < capacity) {
-        validCount++;
+    std::copy(data, data + size, target);
+    commitPush(size);
+}
+
+uint8_t* RewindBuffer::beginPush(size_t size) {
+    if (capacity == 0) {
+        return nullptr;
+    }
+
+    if (storesInPlace()) {
+        if (!reserveSpace(size, &reservedOffset)) {
+            return nullptr;
+        }
+        hasReservation = true;
+        return storage.get() + reservedOffset;
     }
+
+    if (pendingState.size() < size) {
+        pendingState.resize(size);
+    }
+    return pendingState.data();
+}
+
+void RewindBuffer::commitPush(size_t size) {
+    if (storesInPlace()) {
+        if (hasReservation) {
+            hasReservation = false;
+            appendEntry(Entry { reservedOffset, size, size, size, true, false });
+        }
+    } else if (mode == Mode::FULL) {
+        storeEntry(pendingState.data(), size, size, true);
+    } else {
+        commitDelta(size);
+    }
+
+    publishStats();
+}
+
+void RewindBuffer::cancelPush() {
+    // Entries evicted to make room are gone either way, the reservation is simply dropped.
+    hasReservation = false;
+    publishStats();
 }
 
 bool RewindBuffer::pop(uint8_t* outData, size_t* outSize) {
-    if (validCount == 0) {
+    if (validCount() == 0) {
+        return false;
+    }
+
+    bool result = mode == Mode::FULL ? popFull(outData, outSize) : popDelta(outData, outSize);
+    publishStats();
+    return result;
+}
+
+void RewindBuffer::clear() {
+    entryHead = 0;
+    entryCount = 0;
+    usedBytes = 0;
+    hasReservation = false;
+
+    latestSize = 0;
+    hasLatest = false;
+
+    publishStats();
+}
+
+void RewindBuffer::commitDelta(size_t size) {
+    if (hasLatest) {
+        size_t deltaSize = 0;
+        if (latestSize == size && !entries.empty()) {
+            if (encodeBuffer.size() < size) {
+                encodeBuffer.resize(size);
+            }
+            deltaSize = encodeDelta(pendingState.data(), latestState.data(), size, encodeBuffer.data(), size);
+        }
+
+        if (deltaSize > 0) {
+            storeEntry(encodeBuffer.data(), deltaSize, latestSize, false);
+        } else {
+            storeEntry(latestState.data(), latestSize, latestSize, true);
+        }
+        usedBytes -= latestSize;
+    }
+
+    std::swap(latestState, pendingState);
+    latestSize = size;
+    hasLatest = true;
+    usedBytes += size;
+}
+
+bool RewindBuffer::popFull(uint8_t* outData, size_t* outSize) {
+    Entry entry = entryAt(entryCount - 1);
+    entryCount--;
+    usedBytes -= entry.size;
+
+    *outSize = entry.stateSize;
+    return readEntry(entry, outData);
+}
+
+bool RewindBuffer::popDelta(uint8_t* outData, size_t* outSize) {
+    *outSize = latestSize;
+    std::copy(latestState.begin(), latestState.begin() + latestSize, outData);
+    usedBytes -= latestSize;
+
+    if (entryCount == 0) {
+        hasLatest = false;
+        latestSize = 0;
+        return true;
+    }
+
+    Entry entry = entryAt(entryCount - 1);
+    entryCount--;
+    usedBytes -= entry.size;
+
+    if (latestState.size() < entry.stateSize) {
+        latestState.resize(entry.stateSize);
+    }
+
+    bool decoded;
+    if (entry.keyframe) {
+        decoded = readEntry(entry, latestState.data());
+    } else {
+        if (encodeBuffer.size() < entry.rawSize) {
+            encodeBuffer.resize(entry.rawSize);
+        }
+        decoded = readEntry(entry, encodeBuffer.data());
+        if (decoded) {
+            applyDelta(encodeBuffer.data(), entry.rawSize, latestState.data(), entry.stateSize);
+        }
+    }
+
+    if (!decoded) {
+        // Older states can't be rebuilt without this one. The popped state itself is fine.
+        clear();
+        return true;
+    }
+
+    latestSize = entry.stateSize;
+    usedBytes += latestSize;
+
+    return true;
+}
+
+RewindBuffer::Entry& RewindBuffer::entryAt(size_t index) {
+    return entries[(entryHead + index) % entries.size()];
+}
+
+// Entries are laid out in the storage ring from oldest to newest. New entries go right after the
+// newest one, wrapping to the start when the tail is too short (the leftover tail is wasted).
+bool RewindBuffer::findSpace(size_t size, size_t* offset) {
+    if (entryCount == 0) {
+        *offset = 0;
+        return size <= storageSize;
+    }
+
+    const Entry& oldest = entryAt(0);
+    const Entry& newest = entryAt(entryCount - 1);
+    size_t tail = newest.offset + newest.size;
+
+    if (oldest.offset <= newest.offset) {
+        if (storageSize - tail >= size) {
+            *offset = tail;
+            return true;
+        }
+        if (oldest.offset >= size) {
+            *offset = 0;
+            return true;
+        }
         return false;
     }
 
-    size_t readIndex = (writeIndex + capacity - 1) % capacity;
-    writeIndex = readIndex;
-    validCount--;
+    if (oldest.offset - tail >= size) {
+        *offset = tail;
+        return true;
+    }
+    return false;
+}
 
-    const auto& slot = slots[readIndex];
-    *outSize = slot.size();
-    std::copy(slot.begin(), slot.end(), outData);
+bool RewindBuffer::reserveSpace(size_t size, size_t* offset) {
+    if (entries.empty()) {
+        return false;
+    }
 
+    if (entryCount == entries.size()) {
+        evictOldest();
+    }
+
+    while (!findSpace(size, offset)) {
+        if (entryCount == 0) {
+            // This entry alone exceeds the budget.
+            return false;
+        }
+        evictOldest();
+    }
     return true;
 }
 
-void RewindBuffer::clear() {
-    for (auto& slot : slots) {
-        slot.clear();
+void RewindBuffer::evictOldest() {
+    usedBytes -= entryAt(0).size;
+    entryHead = (entryHead + 1) % entries.size();
+    entryCount--;
+}
+
+void RewindBuffer::appendEntry(const Entry& entry) {
+    entryCount++;
+    entryAt(entryCount - 1) = entry;
+    usedBytes += entry.size;
+}
+
+void RewindBuffer::storeEntry(const uint8_t* payload, size_t payloadSize, size_t stateSize, bool keyframe) {
+    if (entries.empty()) {
+        return;
+    }
+
+    const uint8_t* data = payload;
+    size_t dataSize = payloadSize;
+    bool compressed = false;
+
+    if (codec.getType() != RewindCodec::Type::NONE && payloadSize > 1) {
+        if (compressBuffer.size() < payloadSize) {
+            compressBuffer.resize(payloadSize);
+        }
+
+        // Only keep the compressed payload when it actually saves space.
+        size_t compressedSize = codec.compress(payload, payloadSize, compressBuffer.data(), payloadSize - 1);
+        if (compressedSize > 0) {
+            data = compressBuffer.data();
+            dataSize = compressedSize;
+            compressed = true;
+        }
+    }
+
+    size_t offset = 0;
+    if (!reserveSpace(dataSize, &offset)) {
+        return;
+    }
+
+    std::copy(data, data + dataSize, storage.get() + offset);
+    appendEntry(Entry { offset, dataSize, payloadSize, stateSize, keyframe, compressed });
+}
+
+bool RewindBuffer::readEntry(const Entry& entry, uint8_t* out) {
+    const uint8_t* payload = storage.get() + entry.offset;
+    if (entry.compressed) {
+        return codec.decompress(payload, entry.size, out, entry.rawSize);
+    }
+
+    std::copy(payload, payload + entry.size, out);
+    return true;
+}
+
+// Encodes the bytes of previous which differ from current as a sequence of
+// (skip length, literal length, literal bytes) records. Returns 0 when the encoding would not fit
+// in outCapacity, in which case the caller should store a keyframe.
+size_t RewindBuffer::encodeDelta(
+    const uint8_t* current,
+    const uint8_t* previous,
+    size_t size,
+    uint8_t* out,
+    size_t outCapacity
+) {
+    size_t position = 0;
+    size_t written = 0;
+
+    while (position < size) {
+        size_t skipStart = position;
+        while (position + 8 <= size && equalWords(current + position, previous + position)) {
+            position += 8;
+        }
+        while (position < size && current[position] == previous[position]) {
+            position++;
+        }
+        size_t skip = position - skipStart;
+
+        size_t literalStart = position;
+        while (position < size) {
+            if (current[position] != previous[position]) {
+                position++;
+                continue;
+            }
+
+            size_t runEnd = position;
+            while (runEnd < size && runEnd - position < MIN_SKIP_RUN && current[runEnd] == previous[runEnd]) {
+                runEnd++;
+            }
+            if (runEnd - position >= MIN_SKIP_RUN || runEnd == size) {
+                break;
+            }
+            position = runEnd;
+        }
+        size_t literal = position - literalStart;
+
+        if (written + MAX_RUN_HEADER_SIZE + literal > outCapacity) {
+            return 0;
+        }
+
+        written += writeVarint(out + written, skip);
+        written += writeVarint(out + written, literal);
+        memcpy(out + written, previous + literalStart, literal);
+        written += literal;
+    }
+
+    return written;
+}
+
+void RewindBuffer::applyDelta(const uint8_t* delta, size_t deltaSize, uint8_t* state, size_t stateSize) {
+    size_t position = 0;
+    size_t statePosition = 0;
+
+    while (position < deltaSize) {
+        size_t skip = 0;
+        size_t literal = 0;
+
+        size_t read = readVarint(delta + position, deltaSize - position, &skip);
+        if (read == 0) return;
+        position += read;
+
+        read = readVarint(delta + position, deltaSize - position, &literal);
+        if (read == 0) return;
+        position += read;
+
+        // Written as differences, so corrupt lengths cannot wrap around.
+        if (skip > stateSize - statePosition) {
+            return;
+        }
+        statePosition += skip;
+        if (literal > stateSize - statePosition || literal > deltaSize - position) {
+            return;
+        }
+
+        memcpy(state + statePosition, delta + position, literal);
+        position += literal;
+        statePosition += literal;
     }
-    writeIndex = 0;
-    validCount = 0;
 }
 
 }
@@ -18,30 +18,127 @@
 #ifndef LIBRETRODROID_REWINDBUFFER_H
 #define LIBRETRODROID_REWINDBUFFER_H
 
+#include <atomic>
 #include <vector>
+#include <memory>
 #include <cstdint>
 #include <cstddef>
 
+#include "rewindcodec.h"
+
 namespace libretrodroid {
 
 class RewindBuffer {
 public:
-    RewindBuffer(size_t slotCount, size_t maxStateSize);
+    enum class Mode {
+        FULL = 0,
+        DELTA = 1,
+    };
+
+    // budgetBytes bounds the memory used to store states, zero picks slotCount * maxStateSize.
+    // In FULL mode slotCount also bounds the number of states. In DELTA mode the budget (which
+    // includes the newest state, kept in full) is the limit, so the same memory holds many more
+    // states; slotCount only caps the entry table at slotCount * 64 states.
+    RewindBuffer(
+        size_t slotCount,
+        size_t maxStateSize,
+        Mode mode = Mode::FULL,
+        size_t budgetBytes = 0,
+        RewindCodec::Type codecType = RewindCodec::Type::NONE
+    );
     ~RewindBuffer();
 
     void push(const uint8_t* data, size_t size);
     bool pop(uint8_t* outData, size_t* outSize);
     void clear();
 
-    size_t getValidCount() const { return validCount; }
+    // Zero-copy push: beginPush returns a buffer of at least size bytes which the caller fills
+    // (typically with retro_serialize) before calling commitPush, or cancelPush on failure.
+    uint8_t* beginPush(size_t size);
+    void commitPush(size_t size);
+    void cancelPush();
+
+    // Statistics can be read from any thread while another one pushes. They are published after
+    // every push, pop and clear.
+    size_t getValidCount() const { return publishedValidCount.load(std::memory_order_relaxed); }
     size_t getCapacity() const { return capacity; }
-    float getUsage() const { return capacity > 0 ? (float)validCount / (float)capacity : 0.0f; }
+    float getUsage() const;
+
+    size_t getUsedBytes() const { return publishedUsedBytes.load(std::memory_order_relaxed); }
+    size_t getCapacityBytes() const { return publishedCapacityBytes.load(std::memory_order_relaxed); }
+
+    Mode getMode() const { return mode; }
 
 private:
-    std::vector<std::vector<uint8_t>> slots;
-    size_t writeIndex = 0;
-    size_t validCount = 0;
+    // Every stored state is an entry in a byte ring, ordered from oldest to newest.
+    //
+    // In FULL mode each entry is a whole state. In DELTA mode only the newest state is kept in
+    // full, outside of the ring. Every older state is stored as a backward delta against the
+    // next newer state (unchanged runs are skipped, changed bytes are stored verbatim) so popping
+    // costs a single decode and the oldest entry can always be dropped without rebasing anything.
+    // A keyframe entry holds the raw state instead, and is used when the state size changed or
+    // when the delta would not be smaller than the state itself.
+    //
+    // Entry payloads are additionally compressed with the codec when that makes them smaller.
+    struct Entry {
+        size_t offset;
+        size_t size;
+        size_t rawSize;
+        size_t stateSize;
+        bool keyframe;
+        bool compressed;
+    };
+
+    bool storesInPlace() const;
+    size_t validCount() const { return entryCount + (hasLatest ? 1 : 0); }
+    void publishStats();
+
+    void commitDelta(size_t size);
+    bool popFull(uint8_t* outData, size_t* outSize);
+    bool popDelta(uint8_t* outData, size_t* outSize);
+
+    Entry& entryAt(size_t index);
+    bool findSpace(size_t size, size_t* offset);
+    bool reserveSpace(size_t size, size_t* offset);
+    void evictOldest();
+    void appendEntry(const Entry& entry);
+    void storeEntry(const uint8_t* payload, size_t payloadSize, size_t stateSize, bool keyframe);
+    bool readEntry(const Entry& entry, uint8_t* out);
+
+    static size_t encodeDelta(const uint8_t* current, const uint8_t* previous, size_t size, uint8_t* out, size_t outCapacity);
+    static void applyDelta(const uint8_t* delta, size_t deltaSize, uint8_t* state, size_t stateSize);
+
+private:
+    Mode mode;
+    size_t maxStateSize;
     size_t capacity;
+
+    size_t usedBytes = 0;
+
+    // Left uninitialized on purpose, so an unused budget is never touched.
+    std::unique_ptr<uint8_t[]> storage;
+    size_t storageSize = 0;
+
+    std::vector<Entry> entries;
+    size_t entryHead = 0;
+    size_t entryCount = 0;
+
+    size_t reservedOffset = 0;
+    bool hasReservation = false;
+
+    std::vector<uint8_t> latestState;
+    size_t latestSize = 0;
+    bool hasLatest = false;
+
+    std::vector<uint8_t> pendingState;
+    std::vector<uint8_t> encodeBuffer;
+    std::vector<uint8_t> compressBuffer;
+
+    RewindCodec codec;
+
+    std::atomic<size_t> publishedValidCount { 0 };
+    std::atomic<size_t> publishedUsedBytes { 0 };
+    std::atomic<size_t> publishedCapacityBytes { 0 };
 };
 
 }
@@ -0,0 +1,103 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "rewindcapture.h"
+
+namespace libretrodroid {
+
+AsyncRewindCapture::AsyncRewindCapture(RewindBuffer& rewindBuffer, size_t poolSize, size_t maxStateSize)
+    : rewindBuffer(rewindBuffer), pool(poolSize), freeBuffers(poolSize), pendingJobs(poolSize) {
+
+    for (uint32_t i = 0; i < poolSize; i++) {
+        pool[i].resize(maxStateSize);
+        freeBuffers.push(i);
+    }
+
+    worker = std::thread(&AsyncRewindCapture::run, this);
+}
+
+AsyncRewindCapture::~AsyncRewindCapture() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    workAvailable.notify_one();
+    worker.join();
+}
+
+uint8_t* AsyncRewindCapture::acquire(size_t size) {
+    // A cancelled capture keeps its buffer, so it is simply reused here.
+    if (acquiredBuffer == NO_BUFFER && !freeBuffers.pop(acquiredBuffer)) {
+        acquiredBuffer = NO_BUFFER;
+        droppedCount++;
+        return nullptr;
+    }
+
+    auto& buffer = pool[acquiredBuffer];
+    if (buffer.size() < size) {
+        buffer.resize(size);
+    }
+    return buffer.data();
+}
+
+void AsyncRewindCapture::submit(size_t size) {
+    if (acquiredBuffer == NO_BUFFER) {
+        return;
+    }
+
+    inFlight.fetch_add(1, std::memory_order_acq_rel);
+    pendingJobs.push(Job { acquiredBuffer, size });
+    acquiredBuffer = NO_BUFFER;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+    workAvailable.notify_one();
+}
+
+void AsyncRewindCapture::cancel() {
+    // Nothing to do, the acquired buffer stays ours until the next capture.
+}
+
+void AsyncRewindCapture::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    workDrained.wait(lock, [&] { return inFlight.load(std::memory_order_acquire) == 0; });
+}
+
+void AsyncRewindCapture::run() {
+    while (true) {
+        Job job {};
+        if (pendingJobs.pop(job)) {
+            rewindBuffer.push(pool[job.bufferIndex].data(), job.size);
+            freeBuffers.push(job.bufferIndex);
+
+            if (inFlight.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(mutex);
+                workDrained.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        workAvailable.wait(lock, [&] { return !running || !pendingJobs.empty(); });
+        if (!running) {
+            return;
+        }
+    }
+}
+
+}
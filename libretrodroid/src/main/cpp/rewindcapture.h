@@ -0,0 +1,84 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_REWINDCAPTURE_H
+#define LIBRETRODROID_REWINDCAPTURE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rewindbuffer.h"
+#include "utils/spscqueue.h"
+
+namespace libretrodroid {
+
+// Moves rewind storage off the emulation thread. The emulation thread serializes into one of a
+// few pooled buffers and hands it over, a worker thread then pushes it into the RewindBuffer
+// (delta encoding and ring insertion) and returns the buffer to the pool.
+// When the worker falls behind and the pool is exhausted, captures are dropped instead of
+// blocking the emulation thread.
+class AsyncRewindCapture {
+public:
+    AsyncRewindCapture(RewindBuffer& rewindBuffer, size_t poolSize, size_t maxStateSize);
+    ~AsyncRewindCapture();
+
+    // Emulation thread only.
+    uint8_t* acquire(size_t size);
+    void submit(size_t size);
+    void cancel();
+
+    // Blocks until every submitted capture reached the RewindBuffer. Must be called before the
+    // emulation thread touches the RewindBuffer directly (pop, clear).
+    void flush();
+
+    size_t getDroppedCount() const { return droppedCount; }
+
+private:
+    struct Job {
+        uint32_t bufferIndex;
+        size_t size;
+    };
+
+    void run();
+
+private:
+    static constexpr uint32_t NO_BUFFER = UINT32_MAX;
+
+    RewindBuffer& rewindBuffer;
+
+    std::vector<std::vector<uint8_t>> pool;
+    SPSCQueue<uint32_t> freeBuffers;
+    SPSCQueue<Job> pendingJobs;
+    uint32_t acquiredBuffer = NO_BUFFER;
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDrained;
+    std::atomic<size_t> inFlight { 0 };
+    bool running = true;
+    size_t droppedCount = 0;
+
+    std::thread worker;
+};
+
+}
+
+#endif //LIBRETRODROID_REWINDCAPTURE_H
@@ -0,0 +1,284 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "rewindcodec.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace libretrodroid {
+
+// FAST_LZ is an LZ4-style block format. Every sequence is a token (literal length in the high
+// nibble, match length - 4 in the low nibble), optional length extension bytes, the literals,
+// a 16-bit little endian offset and optional match length extension bytes. The last sequence
+// only carries literals.
+static constexpr size_t MIN_MATCH = 4;
+static constexpr size_t MAX_OFFSET = 65535;
+static constexpr size_t LAST_LITERALS = 5;
+static constexpr size_t MATCH_SEARCH_LIMIT = 12;
+
+static inline uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t hashSequence(uint32_t sequence, unsigned bits) {
+    return (sequence * 2654435761u) >> (32 - bits);
+}
+
+static inline bool writeLength(uint8_t*& op, const uint8_t* outEnd, size_t length) {
+    while (length >= 255) {
+        if (op >= outEnd) return false;
+        *op++ = 255;
+        length -= 255;
+    }
+    if (op >= outEnd) return false;
+    *op++ = (uint8_t) length;
+    return true;
+}
+
+static inline bool readLength(const uint8_t*& ip, const uint8_t* inEnd, size_t& length) {
+    uint8_t byte;
+    do {
+        if (ip >= inEnd) return false;
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+static bool writeSequence(
+    uint8_t*& op,
+    const uint8_t* outEnd,
+    const uint8_t* literals,
+    size_t literalLength,
+    size_t offset,
+    size_t matchLength
+) {
+    if (op >= outEnd) return false;
+    uint8_t* token = op++;
+
+    size_t literalNibble = std::min<size_t>(literalLength, 15);
+    if (literalLength >= 15 && !writeLength(op, outEnd, literalLength - 15)) {
+        return false;
+    }
+
+    if ((size_t) (outEnd - op) < literalLength) return false;
+    if (literalLength > 0) {
+        memcpy(op, literals, literalLength);
+        op += literalLength;
+    }
+
+    if (matchLength == 0) {
+        *token = (uint8_t) (literalNibble << 4);
+        return true;
+    }
+
+    if (outEnd - op < 2) return false;
+    *op++ = (uint8_t) (offset & 0xFF);
+    *op++ = (uint8_t) (offset >> 8);
+
+    size_t matchCode = matchLength - MIN_MATCH;
+    size_t matchNibble = std::min<size_t>(matchCode, 15);
+    if (matchCode >= 15 && !writeLength(op, outEnd, matchCode - 15)) {
+        return false;
+    }
+
+    *token = (uint8_t) ((literalNibble << 4) | matchNibble);
+    return true;
+}
+
+RewindCodec::RewindCodec(Type type) : type(type) {
+    if (type == Type::FAST_LZ) {
+        hashTable.resize(1u << FAST_LZ_HASH_BITS);
+    }
+
+    if (type == Type::DEFLATE) {
+        bool deflateReady = deflateInit(&deflater, DEFLATE_LEVEL) == Z_OK;
+        bool inflateReady = inflateInit(&inflater) == Z_OK;
+        zlibInitialized = deflateReady && inflateReady;
+        if (!zlibInitialized) {
+            if (deflateReady) deflateEnd(&deflater);
+            if (inflateReady) inflateEnd(&inflater);
+            this->type = Type::NONE;
+        }
+    }
+}
+
+RewindCodec::~RewindCodec() {
+    if (zlibInitialized) {
+        deflateEnd(&deflater);
+        inflateEnd(&inflater);
+    }
+}
+
+size_t RewindCodec::compress(const uint8_t* in, size_t inSize, uint8_t* out, size_t outCapacity) {
+    switch (type) {
+        case Type::FAST_LZ:
+            return compressFastLZ(in, inSize, out, outCapacity);
+        case Type::DEFLATE:
+            return compressDeflate(in, inSize, out, outCapacity);
+        case Type::NONE:
+        default:
+            if (inSize > outCapacity) return 0;
+            memcpy(out, in, inSize);
+            return inSize;
+    }
+}
+
+bool RewindCodec::decompress(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize) {
+    switch (type) {
+        case Type::FAST_LZ:
+            return decompressFastLZ(in, inSize, out, outSize);
+        case Type::DEFLATE:
+            return decompressDeflate(in, inSize, out, outSize);
+        case Type::NONE:
+        default:
+            if (inSize != outSize) return false;
+            memcpy(out, in, inSize);
+            return true;
+    }
+}
+
+size_t RewindCodec::compressFastLZ(const uint8_t* in, size_t inSize, uint8_t* out, size_t outCapacity) {
+    uint8_t* op = out;
+    const uint8_t* outEnd = out + outCapacity;
+
+    size_t anchor = 0;
+    size_t position = 0;
+
+    if (inSize >= MATCH_SEARCH_LIMIT) {
+        std::fill(hashTable.begin(), hashTable.end(), 0);
+        size_t searchEnd = inSize - MATCH_SEARCH_LIMIT;
+
+        while (position < searchEnd) {
+            uint32_t sequence = read32(in + position);
+            uint32_t hash = hashSequence(sequence, FAST_LZ_HASH_BITS);
+            size_t reference = hashTable[hash];
+            hashTable[hash] = (uint32_t) position;
+
+            bool isMatch = reference < position
+                && position - reference <= MAX_OFFSET
+                && read32(in + reference) == sequence;
+
+            if (!isMatch) {
+                // Skip faster through data that does not compress.
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+
+            size_t matchLength = MIN_MATCH;
+            size_t matchEnd = inSize - LAST_LITERALS;
+            while (position + matchLength < matchEnd && in[reference + matchLength] == in[position + matchLength]) {
+                matchLength++;
+            }
+
+            if (!writeSequence(op, outEnd, in + anchor, position - anchor, position - reference, matchLength)) {
+                return 0;
+            }
+
+            position += matchLength;
+            anchor = position;
+        }
+    }
+
+    if (!writeSequence(op, outEnd, in + anchor, inSize - anchor, 0, 0)) {
+        return 0;
+    }
+
+    return op - out;
+}
+
+bool RewindCodec::decompressFastLZ(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize) {
+    const uint8_t* ip = in;
+    const uint8_t* inEnd = in + inSize;
+    uint8_t* op = out;
+    uint8_t* outEnd = out + outSize;
+
+    while (ip < inEnd) {
+        uint8_t token = *ip++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(ip, inEnd, literalLength)) {
+            return false;
+        }
+
+        if ((size_t) (inEnd - ip) < literalLength || (size_t) (outEnd - op) < literalLength) {
+            return false;
+        }
+        memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        if (ip == inEnd) {
+            break;
+        }
+
+        if (inEnd - ip < 2) return false;
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+
+        size_t matchLength = token & 0x0F;
+        if (matchLength == 15 && !readLength(ip, inEnd, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+
+        if (offset == 0 || offset > (size_t) (op - out) || (size_t) (outEnd - op) < matchLength) {
+            return false;
+        }
+
+        const uint8_t* match = op - offset;
+        if (offset >= matchLength) {
+            memcpy(op, match, matchLength);
+            op += matchLength;
+        } else {
+            // Overlapping copy, used to encode runs.
+            for (size_t i = 0; i < matchLength; i++) {
+                *op++ = *match++;
+            }
+        }
+    }
+
+    return op == outEnd;
+}
+
+size_t RewindCodec::compressDeflate(const uint8_t* in, size_t inSize, uint8_t* out, size_t outCapacity) {
+    deflateReset(&deflater);
+    deflater.next_in = const_cast<Bytef*>(in);
+    deflater.avail_in = (uInt) inSize;
+    deflater.next_out = out;
+    deflater.avail_out = (uInt) outCapacity;
+
+    if (deflate(&deflater, Z_FINISH) != Z_STREAM_END) {
+        return 0;
+    }
+    return deflater.total_out;
+}
+
+bool RewindCodec::decompressDeflate(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize) {
+    inflateReset(&inflater);
+    inflater.next_in = const_cast<Bytef*>(in);
+    inflater.avail_in = (uInt) inSize;
+    inflater.next_out = out;
+    inflater.avail_out = (uInt) outSize;
+
+    return inflate(&inflater, Z_FINISH) == Z_STREAM_END && inflater.total_out == outSize;
+}
+
+}
@@ -0,0 +1,76 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_REWINDCODEC_H
+#define LIBRETRODROID_REWINDCODEC_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include <zlib.h>
+
+namespace libretrodroid {
+
+// Block codec used to compress rewind entries. Each instance owns its working memory, so
+// compressing and decompressing never allocates.
+class RewindCodec {
+public:
+    enum class Type {
+        NONE = 0,
+        FAST_LZ = 1,
+        DEFLATE = 2,
+    };
+
+    explicit RewindCodec(Type type);
+    ~RewindCodec();
+
+    RewindCodec(const RewindCodec&) = delete;
+    RewindCodec& operator=(const RewindCodec&) = delete;
+
+    Type getType() const { return type; }
+
+    // Returns the compressed size, or 0 when the result would not fit in outCapacity.
+    size_t compress(const uint8_t* in, size_t inSize, uint8_t* out, size_t outCapacity);
+
+    // Returns true only if exactly outSize bytes were decoded.
+    bool decompress(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize);
+
+private:
+    size_t compressFastLZ(const uint8_t* in, size_t inSize, uint8_t* out, size_t outCapacity);
+    bool decompressFastLZ(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize);
+
+    size_t compressDeflate(const uint8_t* in, size_t inSize, uint8_t* out, size_t outCapacity);
+    bool decompressDeflate(const uint8_t* in, size_t inSize, uint8_t* out, size_t outSize);
+
+private:
+    static constexpr unsigned FAST_LZ_HASH_BITS = 12;
+
+    // Speed matters more than ratio here, captures run every frame.
+    static constexpr int DEFLATE_LEVEL = 3;
+
+    Type type;
+    std::vector<uint32_t> hashTable;
+
+    z_stream deflater {};
+    z_stream inflater {};
+    bool zlibInitialized = false;
+};
+
+}
+
+#endif //LIBRETRODROID_REWINDCODEC_H
@@ -0,0 +1,141 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "srammonitor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log.h"
+
+namespace libretrodroid {
+
+static bool writeFully(int fd, const uint8_t* data, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t written = pwrite(fd, data, size, offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= written;
+        offset += written;
+    }
+    return true;
+}
+
+SRAMMonitor::SRAMMonitor(size_t pageSize) : pageSize(std::max<size_t>(pageSize, 1)) { }
+
+void SRAMMonitor::reset(const uint8_t* sram, size_t size) {
+    shadow.assign(sram, sram + size);
+    dirtyPages.assign((size + pageSize - 1) / pageSize, false);
+    framesSinceScan = 0;
+}
+
+void SRAMMonitor::onFrame(const uint8_t* sram, size_t size) {
+    if (++framesSinceScan < SCAN_INTERVAL_FRAMES) {
+        return;
+    }
+    scan(sram, size);
+}
+
+void SRAMMonitor::scan(const uint8_t* sram, size_t size) {
+    framesSinceScan = 0;
+
+    if (size != shadow.size()) {
+        // The core resized its save RAM, nothing on disk can be trusted anymore.
+        shadow.assign(sram, sram + size);
+        dirtyPages.assign((size + pageSize - 1) / pageSize, false);
+        markAllDirty();
+        return;
+    }
+
+    for (size_t page = 0; page < dirtyPages.size(); page++) {
+        if (dirtyPages[page]) {
+            continue;
+        }
+
+        size_t offset = page * pageSize;
+        size_t length = std::min(pageSize, size - offset);
+        if (memcmp(sram + offset, shadow.data() + offset, length) != 0) {
+            dirtyPages[page] = true;
+        }
+    }
+}
+
+std::vector<uint32_t> SRAMMonitor::getDirtyPages() const {
+    std::vector<uint32_t> result;
+    for (size_t page = 0; page < dirtyPages.size(); page++) {
+        if (dirtyPages[page]) {
+            result.push_back(page);
+        }
+    }
+    return result;
+}
+
+ssize_t SRAMMonitor::flush(int fd, const uint8_t* sram, size_t size) {
+    scan(sram, size);
+
+    // A missing or truncated file needs everything, not only what changed.
+    struct stat fileStat {};
+    if (fstat(fd, &fileStat) != 0) {
+        LOGE("Cannot stat SRAM file: %s", strerror(errno));
+        return -1;
+    }
+    if ((size_t) fileStat.st_size < size) {
+        markAllDirty();
+    }
+
+    ssize_t total = 0;
+    size_t page = 0;
+    while (page < dirtyPages.size()) {
+        if (!dirtyPages[page]) {
+            page++;
+            continue;
+        }
+
+        // Consecutive dirty pages are written with a single call.
+        size_t lastPage = page;
+        while (lastPage + 1 < dirtyPages.size() && dirtyPages[lastPage + 1]) {
+            lastPage++;
+        }
+
+        size_t offset = page * pageSize;
+        size_t length = std::min((lastPage + 1) * pageSize, size) - offset;
+        if (!writeFully(fd, sram + offset, length, (off_t) offset)) {
+            LOGE("Cannot write SRAM pages: %s", strerror(errno));
+            return -1;
+        }
+
+        std::copy(sram + offset, sram + offset + length, shadow.begin() + offset);
+        std::fill(dirtyPages.begin() + page, dirtyPages.begin() + lastPage + 1, false);
+
+        total += length;
+        page = lastPage + 1;
+    }
+
+    return total;
+}
+
+void SRAMMonitor::markAllDirty() {
+    std::fill(dirtyPages.begin(), dirtyPages.end(), true);
+}
+
+}
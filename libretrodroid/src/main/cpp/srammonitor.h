@@ -0,0 +1,65 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_SRAMMONITOR_H
+#define LIBRETRODROID_SRAMMONITOR_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <sys/types.h>
+
+namespace libretrodroid {
+
+// Tracks which pages of the save RAM changed since it was last written to disk, by comparing them
+// against a shadow copy of the persisted content. Flushing only rewrites the dirty pages in place
+// instead of the whole save file.
+class SRAMMonitor {
+public:
+    static constexpr size_t DEFAULT_PAGE_SIZE = 4096;
+
+    // Pages are compared once every SCAN_INTERVAL_FRAMES frames, and always before a flush.
+    static constexpr unsigned SCAN_INTERVAL_FRAMES = 30;
+
+    explicit SRAMMonitor(size_t pageSize = DEFAULT_PAGE_SIZE);
+
+    // Takes the current content as the one stored on disk.
+    void reset(const uint8_t* sram, size_t size);
+
+    void onFrame(const uint8_t* sram, size_t size);
+    void scan(const uint8_t* sram, size_t size);
+
+    std::vector<uint32_t> getDirtyPages() const;
+    size_t getPageSize() const { return pageSize; }
+
+    // Writes the dirty pages to fd at their offset. Returns the number of bytes written, or -1 on
+    // error, in which case the pages stay dirty.
+    ssize_t flush(int fd, const uint8_t* sram, size_t size);
+
+private:
+    void markAllDirty();
+
+private:
+    size_t pageSize;
+    std::vector<uint8_t> shadow;
+    std::vector<bool> dirtyPages;
+    unsigned framesSinceScan = 0;
+};
+
+}
+
+#endif //LIBRETRODROID_SRAMMONITOR_H
@@ -0,0 +1,254 @@
+#include "audio.h"
+#include "audiotelemetry.h"
+#include "resamplers/linearresampler.h"
+#include "resamplers/polyphaseresampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace libretrodroid;
+
+namespace {
+
+constexpr double OUTPUT_RATE = 48000.0;
+constexpr double SIMULATED_SECONDS = 120.0;
+constexpr double WARMUP_SECONDS = 10.0;
+
+struct Scenario {
+    const char* name;
+    double coreRate;
+    double contentFps;
+
+    // The core clock really runs this much faster than it declares, like content running on a
+    // display with a slightly different refresh rate.
+    double clockDrift;
+    int32_t burstFrames;
+    bool lowLatency;
+
+    // AAudio streams are opened in float, the legacy ones in int16.
+    bool aaudio;
+};
+
+struct StabilityResult {
+    AudioTelemetry::Snapshot snapshot;
+    uint64_t underrunsAfterWarmup;
+    uint64_t overrunsAfterWarmup;
+    float maxAdjustment;
+    double nanosPerCallbackFrame;
+    bool floatOutput;
+};
+
+// Drives Audio in simulated time: the core writes one video frame of audio at a time, the
+// output asks for bursts of jittered size at the output rate.
+StabilityResult runStability(const Scenario& scenario, Audio::ResamplerType resamplerType) {
+    oboe::AudioStream::defaultSampleRate = (int32_t) OUTPUT_RATE;
+    oboe::AudioStream::defaultFramesPerBurst = scenario.burstFrames;
+    oboe::AudioStreamBuilder::aaudioRecommended = scenario.aaudio;
+
+    AudioTelemetry telemetry;
+    Audio audio((int32_t) scenario.coreRate, scenario.contentFps, scenario.lowLatency, telemetry);
+    audio.setResamplerType(resamplerType);
+    audio.start();
+
+    oboe::AudioStream stream;
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<int32_t> jitter(-scenario.burstFrames / 2, scenario.burstFrames / 2);
+
+    double framePeriod = 1.0 / (scenario.contentFps * (1.0 + scenario.clockDrift));
+    double coreFramesPerVideoFrame = scenario.coreRate / scenario.contentFps;
+    double pendingCoreFrames = 0.0;
+    uint64_t coreIndex = 0;
+
+    std::vector<int16_t> coreBuffer((size_t) coreFramesPerVideoFrame * 2 + 4);
+    // Large enough for the biggest jittered burst in either format.
+    std::vector<float> outputBuffer(scenario.burstFrames * 4);
+
+    double producerTime = 0.0;
+    double consumerTime = 0.0;
+    double callbackNanos = 0.0;
+    uint64_t callbackFrames = 0;
+
+    StabilityResult result {};
+    AudioTelemetry::Snapshot warmup {};
+    bool warmedUp = false;
+
+    while (consumerTime < SIMULATED_SECONDS) {
+        if (!warmedUp && consumerTime >= WARMUP_SECONDS) {
+            warmup = telemetry.getSnapshot();
+            warmedUp = true;
+        }
+
+        if (producerTime <= consumerTime) {
+            pendingCoreFrames += coreFramesPerVideoFrame;
+            auto frames = (size_t) pendingCoreFrames;
+            pendingCoreFrames -= frames;
+
+            for (size_t i = 0; i < frames; i++, coreIndex++) {
+                double t = coreIndex / scenario.coreRate;
+                auto sample = (int16_t) std::lrint(8000.0 * std::sin(2.0 * M_PI * 440.0 * t));
+                coreBuffer[i * 2] = sample;
+                coreBuffer[i * 2 + 1] = sample;
+            }
+
+            audio.write(coreBuffer.data(), frames);
+            producerTime += framePeriod;
+        } else {
+            int32_t numFrames = scenario.burstFrames + jitter(random);
+
+            auto start = std::chrono::steady_clock::now();
+            audio.onAudioReady(&stream, outputBuffer.data(), numFrames);
+            callbackNanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            callbackFrames += numFrames;
+
+            consumerTime += numFrames / OUTPUT_RATE;
+        }
+    }
+
+    result.snapshot = telemetry.getSnapshot();
+    result.floatOutput = audio.isFloatOutput();
+    result.underrunsAfterWarmup = result.snapshot.underruns - warmup.underruns;
+    result.overrunsAfterWarmup = result.snapshot.overruns - warmup.overruns;
+    result.nanosPerCallbackFrame = callbackNanos / callbackFrames;
+
+    std::vector<AudioTelemetry::ControllerSample> trace(AudioTelemetry::CONTROLLER_TRACE_SIZE);
+    size_t count = telemetry.getControllerTrace(trace.data(), trace.size());
+    for (size_t i = 0; i < count; i++) {
+        result.maxAdjustment = std::max(result.maxAdjustment, std::abs(trace[i].proportional + trace[i].integral));
+    }
+
+    return result;
+}
+
+// THD+N of a 1kHz sine resampled at a fixed ratio: a sine at the exact output frequency is fit
+// with least squares and everything left over counts as distortion and noise. The ratio does not
+// depend on the output scale, so int16 and float outputs compare directly.
+template <typename T>
+double measureTHDN(Resampler&& resampler, double inputRate, double outputRate) {
+    constexpr double FREQUENCY = 1000.0;
+    constexpr int32_t OUTPUT_BLOCK = 480;
+    constexpr int BLOCKS = 200;
+    constexpr int SKIPPED_BLOCKS = 20;
+
+    int32_t inputBlock = (int32_t) std::lround(OUTPUT_BLOCK * inputRate / outputRate);
+    // Blocks are whole frames, so the real ratio differs slightly from the requested one.
+    double actualOutputRate = inputRate * OUTPUT_BLOCK / inputBlock;
+
+    std::vector<int16_t> input(inputBlock * 2);
+    std::vector<T> output(OUTPUT_BLOCK * 2);
+    std::vector<double> captured;
+
+    uint64_t inputIndex = 0;
+    for (int block = 0; block < BLOCKS; block++) {
+        for (int32_t i = 0; i < inputBlock; i++, inputIndex++) {
+            auto sample = (int16_t) std::lrint(16000.0 * std::sin(2.0 * M_PI * FREQUENCY * inputIndex / inputRate));
+            input[i * 2] = sample;
+            input[i * 2 + 1] = sample;
+        }
+
+        resampler.resample(input.data(), inputBlock, output.data(), OUTPUT_BLOCK);
+
+        if (block >= SKIPPED_BLOCKS) {
+            for (int32_t i = 0; i < OUTPUT_BLOCK; i++) {
+                captured.push_back(output[i * 2]);
+            }
+        }
+    }
+
+    // Fit a * sin + b * cos + c, the delay of the resampler only changes the phase.
+    double ss = 0, sc = 0, cc = 0, s1 = 0, c1 = 0, n = 0, ys = 0, yc = 0, y1 = 0;
+    for (size_t i = 0; i < captured.size(); i++) {
+        double phase = 2.0 * M_PI * FREQUENCY * i / actualOutputRate;
+        double s = std::sin(phase);
+        double c = std::cos(phase);
+        double y = captured[i];
+        ss += s * s; sc += s * c; cc += c * c; s1 += s; c1 += c; n += 1;
+        ys += y * s; yc += y * c; y1 += y;
+    }
+
+    // Solve the 3x3 normal equations with Cramer's rule.
+    auto det3 = [](double a, double b, double c, double d, double e, double f, double g, double h, double i) {
+        return a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+    };
+    double det = det3(ss, sc, s1, sc, cc, c1, s1, c1, n);
+    double a = det3(ys, sc, s1, yc, cc, c1, y1, c1, n) / det;
+    double b = det3(ss, ys, s1, sc, yc, c1, s1, y1, n) / det;
+    double c = det3(ss, sc, ys, sc, cc, yc, s1, c1, y1) / det;
+
+    double signal = 0.0;
+    double residual = 0.0;
+    for (size_t i = 0; i < captured.size(); i++) {
+        double phase = 2.0 * M_PI * FREQUENCY * i / actualOutputRate;
+        double fit = a * std::sin(phase) + b * std::cos(phase) + c;
+        signal += fit * fit;
+        residual += (captured[i] - fit) * (captured[i] - fit);
+    }
+
+    return 10.0 * std::log10(residual / signal);
+}
+
+const char* resamplerName(Audio::ResamplerType type) {
+    return type == Audio::ResamplerType::LINEAR ? "linear" : "sinc";
+}
+
+}
+
+int main() {
+    const Scenario scenarios[] = {
+        { "snes 32040Hz", 32040.0, 60.0988, 0.0, 192, true, true },
+        { "snes +0.5% drift", 32040.0, 60.0988, 0.005, 192, true, true },
+        { "gba 32768Hz -0.3%", 32768.0, 59.7275, -0.003, 96, true, true },
+        { "psx 44100Hz", 44100.0, 59.94, 0.001, 480, false, false },
+    };
+
+    bool stable = true;
+
+    printf("FIFO stability over %.0f simulated seconds\n\n", SIMULATED_SECONDS);
+    printf("%-20s %-7s %-6s %10s %10s %6s %6s %6s %10s %10s\n",
+        "scenario", "rs", "format", "underruns", "overruns", "p5%", "p50%", "p95%", "max adj", "ns/frame");
+
+    for (const Scenario& scenario : scenarios) {
+        for (auto type : { Audio::ResamplerType::LINEAR, Audio::ResamplerType::POLYPHASE_SINC }) {
+            StabilityResult result = runStability(scenario, type);
+            stable = stable && result.underrunsAfterWarmup == 0 && result.overrunsAfterWarmup == 0;
+
+            printf("%-20s %-7s %-6s %10llu %10llu %6.0f %6.0f %6.0f %10.5f %10.2f\n",
+                scenario.name,
+                resamplerName(type),
+                result.floatOutput ? "float" : "int16",
+                (unsigned long long) result.underrunsAfterWarmup,
+                (unsigned long long) result.overrunsAfterWarmup,
+                result.snapshot.fillP5 * 100,
+                result.snapshot.fillP50 * 100,
+                result.snapshot.fillP95 * 100,
+                result.maxAdjustment,
+                result.nanosPerCallbackFrame);
+        }
+    }
+
+    printf("\nTHD+N of a 1kHz sine (dB)\n\n");
+    printf("%-20s %10s %10s %10s %10s\n", "conversion", "linear", "linear f", "sinc", "sinc f");
+
+    const std::pair<double, double> conversions[] = {
+        { 32040.0, 48000.0 },
+        { 44100.0, 48000.0 },
+        { 48000.0, 44100.0 },
+    };
+
+    for (auto [inputRate, outputRate] : conversions) {
+        char name[32];
+        snprintf(name, sizeof(name), "%.0f -> %.0f", inputRate, outputRate);
+        printf("%-20s %10.1f %10.1f %10.1f %10.1f\n",
+            name,
+            measureTHDN<int16_t>(LinearResampler(), inputRate, outputRate),
+            measureTHDN<float>(LinearResampler(), inputRate, outputRate),
+            measureTHDN<int16_t>(PolyphaseResampler(), inputRate, outputRate),
+            measureTHDN<float>(PolyphaseResampler(), inputRate, outputRate));
+    }
+
+    return stable ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,83 @@
+#include "utils/audioring.h"
+#include "utils/audiosamplebatcher.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace libretrodroid;
+
+namespace {
+
+// An 8-bit core at 48kHz and 60fps submits 800 single frames per retro_run.
+constexpr size_t FRAMES_PER_RUN = 800;
+constexpr size_t RUNS = 20000;
+
+struct Sink {
+    AudioRing ring { FRAMES_PER_RUN * 4 };
+
+    // Stands in for the audio callback, so the ring never fills up.
+    void drain() {
+        AudioRing::Segments segments = ring.beginRead(FRAMES_PER_RUN);
+        ring.endRead(segments.frames());
+    }
+};
+
+int16_t sampleAt(size_t index) {
+    return (int16_t) ((index * 37) & 0x7FFF);
+}
+
+// Previous behaviour: every single frame goes through the audio path on its own.
+double measurePerFrame() {
+    Sink sink;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t run = 0; run < RUNS; run++) {
+        for (size_t i = 0; i < FRAMES_PER_RUN; i++) {
+            int16_t frame[2] = { sampleAt(i), sampleAt(i + 1) };
+            sink.ring.write(frame, 1);
+        }
+        sink.drain();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / (RUNS * FRAMES_PER_RUN);
+}
+
+// Frames are staged and the audio path runs once per retro_run.
+double measureBatched() {
+    Sink sink;
+    AudioSampleBatcher batcher;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t run = 0; run < RUNS; run++) {
+        for (size_t i = 0; i < FRAMES_PER_RUN; i++) {
+            if (batcher.push(sampleAt(i), sampleAt(i + 1))) {
+                sink.ring.write(batcher.data(), batcher.size());
+                batcher.clear();
+            }
+        }
+        sink.ring.write(batcher.data(), batcher.size());
+        batcher.clear();
+        sink.drain();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / (RUNS * FRAMES_PER_RUN);
+}
+
+}
+
+int main() {
+    double perFrame = measurePerFrame();
+    double batched = measureBatched();
+
+    printf("Single sample audio, %zu frames per retro_run\n\n", FRAMES_PER_RUN);
+    printf("%12s %10.2f ns/frame\n", "per frame", perFrame);
+    printf("%12s %10.2f ns/frame\n", "batched", batched);
+    printf("%12s %10.2fx\n", "speedup", perFrame / batched);
+
+    return batched < perFrame ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,129 @@
+#include "utils/framediff.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace libretrodroid;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* name) {
+    printf("%s %s\n", condition ? "[PASS]" : "[FAIL]", name);
+    if (!condition) failures++;
+}
+
+struct Frame {
+    unsigned int width;
+    unsigned int height;
+    size_t pitch;
+    std::vector<uint16_t> pixels;
+
+    Frame(unsigned int width, unsigned int height, size_t pitchPixels)
+        : width(width), height(height), pitch(pitchPixels * 2), pixels(pitchPixels * height) {
+        std::mt19937 random(7);
+        for (uint16_t& pixel : pixels) {
+            pixel = (uint16_t) random();
+        }
+    }
+
+    uint16_t& at(unsigned int x, unsigned int y) {
+        return pixels[y * pitch / 2 + x];
+    }
+
+    const std::vector<FrameDiff::Band>& diff(FrameDiff& frameDiff) const {
+        return frameDiff.update(pixels.data(), width, height, pitch, 2);
+    }
+};
+
+void testKernelMatchesScalar() {
+    std::mt19937 random(3);
+    std::vector<uint8_t> data(4096);
+    for (uint8_t& value : data) {
+        value = (uint8_t) random();
+    }
+
+    bool matches = true;
+    for (size_t rowSize = 0; rowSize <= 130; rowSize += 2) {
+        for (size_t offset = 0; offset < 3; offset++) {
+            uint64_t expected = FrameDiff::hashRowsScalar(data.data() + offset, rowSize, 200, 5);
+            uint64_t actual = FrameDiff::hashRows(data.data() + offset, rowSize, 200, 5);
+            matches = matches && expected == actual;
+        }
+    }
+    check(matches, "Vector hash matches the scalar reference");
+}
+
+void testEveryWordChangesTheHash() {
+    std::vector<uint8_t> data(100 * 3, 0x5A);
+    uint64_t original = FrameDiff::hashRows(data.data(), 94, 100, 3);
+
+    bool allDetected = true;
+    for (size_t row = 0; row < 3; row++) {
+        for (size_t i = 0; i < 94; i++) {
+            data[row * 100 + i] ^= 0x01;
+            allDetected = allDetected && FrameDiff::hashRows(data.data(), 94, 100, 3) != original;
+            data[row * 100 + i] ^= 0x01;
+        }
+    }
+    check(allDetected, "Every single byte change is detected");
+}
+
+void testBands() {
+    Frame frame(256, 224, 320);
+    FrameDiff frameDiff;
+
+    auto& first = frame.diff(frameDiff);
+    check(first.size() == 1 && first[0].firstRow == 0 && first[0].rows == 224, "First frame is fully dirty");
+
+    check(frame.diff(frameDiff).empty(), "Identical frame has no dirty bands");
+
+    frame.at(255, 224 - 1) ^= 1;
+    frame.at(0, 20) ^= 1;
+    frame.at(10, 40) ^= 1;
+    auto& changed = frame.diff(frameDiff);
+    check(changed.size() == 2
+        && changed[0].firstRow == 16 && changed[0].rows == 32
+        && changed[1].firstRow == 208 && changed[1].rows == 16,
+        "Changed bands are reported and adjacent ones merged");
+
+    frame.at(300, 100) ^= 1;
+    check(frame.diff(frameDiff).empty(), "Changes in the row padding are ignored");
+
+    frameDiff.invalidate();
+    check(frame.diff(frameDiff).size() == 1, "Invalidate makes the whole frame dirty");
+
+    Frame smaller(256, 200, 256);
+    auto& resized = smaller.diff(frameDiff);
+    check(resized.size() == 1 && resized[0].rows == 200, "Size change makes the whole frame dirty");
+}
+
+void measureThroughput() {
+    Frame frame(640, 480, 640);
+    FrameDiff frameDiff;
+    constexpr int ITERATIONS = 2000;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        frame.diff(frameDiff);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    printf("\nHashing 640x480 RGB565 frames: %.2f GB/s\n", frame.pixels.size() * 2.0 * ITERATIONS / elapsed.count() / 1.0e9);
+}
+
+}
+
+int main() {
+    testKernelMatchesScalar();
+    testEveryWordChangesTheHash();
+    testBands();
+    measureThroughput();
+
+    printf("\n%d failures\n", failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,81 @@
+#include "utils/pixelconversion.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+using namespace libretrodroid;
+
+namespace {
+
+// A 640x480 frame, the largest common software rendered size, repeated for long enough to
+// average out the timer.
+constexpr unsigned int WIDTH = 640;
+constexpr unsigned int HEIGHT = 480;
+constexpr int ITERATIONS = 2000;
+
+// Source bytes converted per second.
+double measure(size_t frameBytes, const std::function<void()>& convert) {
+    convert();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        convert();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return frameBytes * (double) ITERATIONS / elapsed.count() / 1.0e9;
+}
+
+}
+
+int main() {
+    const size_t pixels = WIDTH * HEIGHT;
+
+    std::vector<uint32_t> source32(pixels);
+    std::vector<uint32_t> destination32(pixels);
+    std::vector<uint16_t> source16(pixels);
+    std::vector<uint16_t> destination16(pixels);
+
+    for (size_t i = 0; i < pixels; i++) {
+        source32[i] = (uint32_t) (i * 2654435761u);
+        source16[i] = (uint16_t) (i * 40503u);
+    }
+
+#if defined(__ARM_NEON)
+    const char* simd = "neon";
+#elif defined(__SSSE3__)
+    const char* simd = "ssse3";
+#elif defined(__SSE2__)
+    const char* simd = "sse2, scalar swizzle";
+#else
+    const char* simd = "none";
+#endif
+
+    printf("%ux%u frames, vector kernels: %s\n\n", WIDTH, HEIGHT, simd);
+    printf("%-20s %12s %12s\n", "conversion", "scalar GB/s", "simd GB/s");
+
+    printf("%-20s %12.2f %12.2f\n",
+        "XRGB8888 swizzle",
+        measure(pixels * 4, [&]() { PixelConversion::swapRedBlue32Scalar(source32.data(), destination32.data(), pixels); }),
+        measure(pixels * 4, [&]() { PixelConversion::swapRedBlue32(source32.data(), destination32.data(), pixels); }));
+
+    printf("%-20s %12.2f %12.2f\n",
+        "0RGB1555 -> RGB565",
+        measure(pixels * 2, [&]() { PixelConversion::rgb1555ToRGB565Scalar(source16.data(), destination16.data(), pixels); }),
+        measure(pixels * 2, [&]() { PixelConversion::rgb1555ToRGB565(source16.data(), destination16.data(), pixels); }));
+
+    // Padded rows go through convertRows one row at a time.
+    const size_t paddedPitch = (WIDTH + 64) * 2;
+    std::vector<uint16_t> padded(paddedPitch / 2 * HEIGHT);
+    printf("%-20s %12s %12.2f\n",
+        "RGB565 repack",
+        "-",
+        measure(pixels * 2, [&]() {
+            PixelConversion::convertRows(PixelConversion::Type::COPY_16, padded.data(), paddedPitch, destination16.data(), WIDTH * 2, WIDTH, HEIGHT);
+        }));
+
+    return EXIT_SUCCESS;
+}
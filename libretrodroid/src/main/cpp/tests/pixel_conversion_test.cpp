@@ -0,0 +1,117 @@
+#include "utils/pixelconversion.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace libretrodroid;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* name) {
+    printf("%s %s\n", condition ? "[PASS]" : "[FAIL]", name);
+    if (!condition) failures++;
+}
+
+template <typename T>
+std::vector<T> randomPixels(size_t count, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::vector<T> result(count);
+    for (T& pixel : result) {
+        pixel = (T) random();
+    }
+    return result;
+}
+
+void testKnownValues() {
+    uint8_t bytes[4] = { 0x11, 0x22, 0x33, 0x44 };
+    uint32_t pixel;
+    std::memcpy(&pixel, bytes, sizeof(pixel));
+
+    uint32_t swapped;
+    PixelConversion::swapRedBlue32(&pixel, &swapped, 1);
+    uint8_t swappedBytes[4];
+    std::memcpy(swappedBytes, &swapped, sizeof(swapped));
+    check(swappedBytes[0] == 0x33 && swappedBytes[1] == 0x22 && swappedBytes[2] == 0x11 && swappedBytes[3] == 0x44,
+        "XRGB8888 swaps red and blue and keeps the rest");
+
+    // Full red, green and blue, with the unused top bit set.
+    uint16_t source[3] = { 0xFC00, 0x83E0, 0x801F };
+    uint16_t converted[3];
+    PixelConversion::rgb1555ToRGB565(source, converted, 3);
+    check(converted[0] == 0xF800 && converted[1] == 0x07C0 && converted[2] == 0x001F,
+        "0RGB1555 moves red and green up and drops the top bit");
+}
+
+// Lengths around the vector widths and unaligned starts hit every tail of the SIMD loops.
+void testMatchesScalar() {
+    auto source32 = randomPixels<uint32_t>(200, 1);
+    auto source16 = randomPixels<uint16_t>(200, 2);
+
+    bool swapMatches = true;
+    bool convertMatches = true;
+
+    for (size_t offset = 0; offset < 3; offset++) {
+        for (size_t count = 0; count < 70; count++) {
+            std::vector<uint32_t> expected32(count), actual32(count);
+            PixelConversion::swapRedBlue32Scalar(source32.data() + offset, expected32.data(), count);
+            PixelConversion::swapRedBlue32(source32.data() + offset, actual32.data(), count);
+            swapMatches = swapMatches && expected32 == actual32;
+
+            std::vector<uint16_t> expected16(count), actual16(count);
+            PixelConversion::rgb1555ToRGB565Scalar(source16.data() + offset, expected16.data(), count);
+            PixelConversion::rgb1555ToRGB565(source16.data() + offset, actual16.data(), count);
+            convertMatches = convertMatches && expected16 == actual16;
+        }
+    }
+
+    check(swapMatches, "XRGB8888 kernel matches the scalar reference");
+    check(convertMatches, "0RGB1555 kernel matches the scalar reference");
+}
+
+void testPaddedRows() {
+    const unsigned int width = 37;
+    const unsigned int height = 5;
+    const size_t sourcePitch = 48 * 2;
+    const size_t rowSize = width * 2;
+
+    auto source = randomPixels<uint16_t>(sourcePitch / 2 * height, 3);
+    auto original = source;
+    std::vector<uint16_t> destination(width * height + 1, 0xBEEF);
+
+    PixelConversion::convertRows(
+        PixelConversion::Type::RGB1555_TO_RGB565,
+        source.data(),
+        sourcePitch,
+        destination.data(),
+        rowSize,
+        width,
+        height
+    );
+
+    bool rowsMatch = true;
+    for (unsigned int row = 0; row < height; row++) {
+        std::vector<uint16_t> expected(width);
+        PixelConversion::rgb1555ToRGB565Scalar(source.data() + row * sourcePitch / 2, expected.data(), width);
+        rowsMatch = rowsMatch && std::memcmp(expected.data(), destination.data() + row * width, rowSize) == 0;
+    }
+
+    check(rowsMatch, "Padded rows are packed tightly");
+    check(destination.back() == 0xBEEF, "Nothing is written past the packed frame");
+    check(source == original, "Source frame is left untouched");
+}
+
+}
+
+int main() {
+    testKnownValues();
+    testMatchesScalar();
+    testPaddedRows();
+
+    printf("\n%d failures\n", failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
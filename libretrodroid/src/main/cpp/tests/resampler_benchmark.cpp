@@ -0,0 +1,107 @@
+#include "resamplers/linearresampler.h"
+#include "resamplers/polyphaseresampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace libretrodroid;
+
+namespace {
+
+constexpr double INPUT_RATE = 32040.0;
+constexpr double OUTPUT_RATE = 48000.0;
+constexpr int OUTPUT_BLOCK = 480;
+constexpr int QUALITY_BLOCKS = 400;
+constexpr int WARMUP_BLOCKS = 8;
+constexpr int TIMING_BLOCKS = 20000;
+constexpr double AMPLITUDE = 12000.0;
+
+// Feeds two sines through the resampler in jittered blocks, like the dynamic rate control does,
+// and compares the left channel against the analytic signal at the expected output positions.
+double measureSNR(Resampler& resampler, double frequency, double delayFrames) {
+    std::vector<int16_t> input(OUTPUT_BLOCK * 4 * 2);
+    std::vector<int16_t> output(OUTPUT_BLOCK * 2);
+
+    double signal = 0.0;
+    double noise = 0.0;
+    long inputIndex = 0;
+
+    for (int block = 0; block < QUALITY_BLOCKS; block++) {
+        double exactFrames = OUTPUT_BLOCK * INPUT_RATE / OUTPUT_RATE;
+        int inputFrames = (int) std::lround(exactFrames) + (block % 3) - 1;
+
+        for (int i = 0; i < inputFrames; i++) {
+            double t = (inputIndex + i) / INPUT_RATE;
+            input[2 * i] = (int16_t) std::lrint(AMPLITUDE * std::sin(2 * M_PI * frequency * t));
+            input[2 * i + 1] = (int16_t) std::lrint(AMPLITUDE * std::sin(2 * M_PI * frequency * 1.3 * t));
+        }
+
+        resampler.resample(input.data(), inputFrames, output.data(), OUTPUT_BLOCK);
+
+        double step = (double) inputFrames / OUTPUT_BLOCK;
+        for (int k = 0; k < OUTPUT_BLOCK && block >= WARMUP_BLOCKS; k++) {
+            double t = (inputIndex + k * step - delayFrames) / INPUT_RATE;
+            double expected = AMPLITUDE * std::sin(2 * M_PI * frequency * t);
+            double error = output[2 * k] - expected;
+            signal += expected * expected;
+            noise += error * error;
+        }
+
+        inputIndex += inputFrames;
+    }
+
+    return 10.0 * std::log10(signal / std::max(noise, 1e-9));
+}
+
+double measureNanosPerFrame(Resampler& resampler) {
+    int inputFrames = (int) std::lround(OUTPUT_BLOCK * INPUT_RATE / OUTPUT_RATE);
+    std::vector<int16_t> input(inputFrames * 2);
+    std::vector<int16_t> output(OUTPUT_BLOCK * 2);
+
+    for (int i = 0; i < inputFrames * 2; i++) {
+        input[i] = (int16_t) (std::rand() % 20000 - 10000);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int block = 0; block < TIMING_BLOCKS; block++) {
+        resampler.resample(input.data(), inputFrames, output.data(), OUTPUT_BLOCK);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    // Keeps the compiler from discarding the output.
+    volatile int16_t sink = output[OUTPUT_BLOCK];
+    (void) sink;
+
+    double nanos = std::chrono::duration<double, std::nano>(end - start).count();
+    return nanos / ((double) TIMING_BLOCKS * OUTPUT_BLOCK);
+}
+
+}
+
+int main() {
+    printf("Resampling %.0f Hz -> %.0f Hz in blocks of %d frames\n\n", INPUT_RATE, OUTPUT_RATE, OUTPUT_BLOCK);
+    printf("%10s %14s %14s\n", "frequency", "linear (dB)", "sinc (dB)");
+
+    bool sincBetter = true;
+    for (double frequency : { 440.0, 2000.0, 6000.0, 12000.0 }) {
+        LinearResampler linear;
+        PolyphaseResampler sinc;
+
+        double linearSNR = measureSNR(linear, frequency, LinearResampler::HISTORY_FRAMES);
+        double sincSNR = measureSNR(sinc, frequency, PolyphaseResampler::HALF_TAPS);
+        sincBetter = sincBetter && sincSNR > linearSNR;
+
+        printf("%10.0f %14.1f %14.1f\n", frequency, linearSNR, sincSNR);
+    }
+
+    LinearResampler linear;
+    PolyphaseResampler sinc;
+    printf("\n%10s %14s %14s\n", "", "linear", "sinc");
+    printf("%10s %14.2f %14.2f\n", "ns/frame", measureNanosPerFrame(linear), measureNanosPerFrame(sinc));
+
+    return sincBetter ? EXIT_SUCCESS : EXIT_FAILURE;
+}
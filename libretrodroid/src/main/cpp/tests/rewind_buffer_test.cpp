@@ -0,0 +1,255 @@
+#include "rewindbuffer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace libretrodroid;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* name) {
+    printf("%s %s\n", condition ? "[PASS]" : "[FAIL]", name);
+    if (!condition) failures++;
+}
+
+const char* modeName(RewindBuffer::Mode mode) {
+    return mode == RewindBuffer::Mode::FULL ? "FULL" : "DELTA";
+}
+
+const char* codecName(RewindCodec::Type type) {
+    switch (type) {
+        case RewindCodec::Type::FAST_LZ: return "FAST_LZ";
+        case RewindCodec::Type::DEFLATE: return "DEFLATE";
+        default: return "NONE";
+    }
+}
+
+// Emulated states: mostly stable RAM where every frame touches a few scattered bytes and a
+// small contiguous block, and once in a while most of the state changes at once.
+class StateGenerator {
+public:
+    explicit StateGenerator(size_t size) : state(size) {
+        for (uint8_t& value : state) {
+            value = (uint8_t) random();
+        }
+    }
+
+    const std::vector<uint8_t>& next() {
+        frame++;
+        if (frame % 37 == 0) {
+            for (size_t i = 0; i < state.size(); i += 2) {
+                state[i] = (uint8_t) random();
+            }
+        } else {
+            for (int i = 0; i < 12; i++) {
+                state[random() % state.size()] ^= (uint8_t) (1 + random() % 255);
+            }
+            size_t block = random() % state.size();
+            for (size_t i = block; i < std::min(block + 40, state.size()); i++) {
+                state[i] = (uint8_t) frame;
+            }
+        }
+        return state;
+    }
+
+    void resize(size_t size) {
+        state.resize(size, 0x3C);
+    }
+
+private:
+    std::mt19937 random { 5 };
+    std::vector<uint8_t> state;
+    unsigned frame = 0;
+};
+
+// Pops everything and checks that the states come back exactly, newest first. Returns the
+// number of states popped, or 0 on mismatch.
+size_t popAndVerify(RewindBuffer& buffer, const std::vector<std::vector<uint8_t>>& history, size_t maxStateSize) {
+    std::vector<uint8_t> output(maxStateSize);
+    size_t expectedCount = buffer.getValidCount();
+    size_t popped = 0;
+    size_t size = 0;
+
+    while (buffer.pop(output.data(), &size)) {
+        if (popped >= history.size()) return 0;
+        const std::vector<uint8_t>& expected = history[history.size() - 1 - popped];
+        if (size != expected.size() || !std::equal(expected.begin(), expected.end(), output.begin())) {
+            return 0;
+        }
+        popped++;
+    }
+
+    return popped == expectedCount && buffer.getValidCount() == 0 ? popped : 0;
+}
+
+void testRoundTrip(RewindBuffer::Mode mode, RewindCodec::Type codec) {
+    constexpr size_t STATE_SIZE = 4096;
+    constexpr size_t SLOTS = 16;
+    char name[128];
+
+    RewindBuffer buffer(SLOTS, STATE_SIZE, mode, 0, codec);
+    StateGenerator generator(STATE_SIZE);
+    std::vector<std::vector<uint8_t>> history;
+
+    for (int i = 0; i < 12; i++) {
+        history.push_back(generator.next());
+        buffer.push(history.back().data(), history.back().size());
+    }
+    snprintf(name, sizeof(name), "%s/%s keeps every state while under budget", modeName(mode), codecName(codec));
+    check(buffer.getValidCount() == history.size(), name);
+
+    snprintf(name, sizeof(name), "%s/%s pops the exact states newest first", modeName(mode), codecName(codec));
+    check(popAndVerify(buffer, history, STATE_SIZE) == history.size(), name);
+}
+
+// Pushes far more states than fit, so old entries are evicted and the storage ring wraps around
+// many times with entries of different sizes, popping a few in between.
+void testWraparound(RewindBuffer::Mode mode, RewindCodec::Type codec) {
+    constexpr size_t STATE_SIZE = 4096;
+    constexpr size_t SLOTS = 8;
+    char name[128];
+
+    RewindBuffer buffer(SLOTS, STATE_SIZE, mode, 0, codec);
+    StateGenerator generator(STATE_SIZE);
+    std::vector<std::vector<uint8_t>> history;
+    std::vector<uint8_t> output(STATE_SIZE);
+
+    bool interleavedPopsMatch = true;
+    bool bounded = true;
+    for (int i = 0; i < 2000; i++) {
+        history.push_back(generator.next());
+        buffer.push(history.back().data(), history.back().size());
+
+        bounded = bounded && buffer.getUsedBytes() <= buffer.getCapacityBytes();
+        if (mode == RewindBuffer::Mode::FULL) {
+            bounded = bounded && buffer.getValidCount() <= SLOTS;
+        }
+
+        if (i % 97 == 96) {
+            size_t size = 0;
+            interleavedPopsMatch = interleavedPopsMatch
+                && buffer.pop(output.data(), &size)
+                && size == STATE_SIZE
+                && std::equal(history.back().begin(), history.back().end(), output.begin());
+            history.pop_back();
+        }
+    }
+
+    snprintf(name, sizeof(name), "%s/%s stays within its budget", modeName(mode), codecName(codec));
+    check(bounded, name);
+
+    snprintf(name, sizeof(name), "%s/%s pops between pushes return the newest state", modeName(mode), codecName(codec));
+    check(interleavedPopsMatch, name);
+
+    size_t kept = buffer.getValidCount();
+    snprintf(name, sizeof(name), "%s/%s pops the newest states exactly after wraparound (%zu kept)", modeName(mode), codecName(codec), kept);
+    check(kept > 1 && popAndVerify(buffer, history, STATE_SIZE) == kept, name);
+}
+
+void testEvictsOldestSlot() {
+    constexpr size_t STATE_SIZE = 256;
+    RewindBuffer buffer(4, STATE_SIZE);
+    StateGenerator generator(STATE_SIZE);
+    std::vector<std::vector<uint8_t>> history;
+
+    for (int i = 0; i < 10; i++) {
+        history.push_back(generator.next());
+        buffer.push(history.back().data(), history.back().size());
+    }
+
+    check(buffer.getValidCount() == 4 && buffer.getUsage() == 1.0f, "FULL evicts the oldest state when the slots are full");
+    check(popAndVerify(buffer, history, STATE_SIZE) == 4, "FULL pops the four newest states");
+
+    std::vector<uint8_t> output(STATE_SIZE);
+    size_t size = 0;
+    check(!buffer.pop(output.data(), &size), "Pop fails once the buffer is empty");
+}
+
+// With the default budget DELTA mode gets the same memory as FULL mode and, since deltas are
+// much smaller than states, keeps far more history in it.
+void testDeltaKeepsMoreHistory() {
+    constexpr size_t STATE_SIZE = 16 * 1024;
+    constexpr size_t SLOTS = 8;
+
+    RewindBuffer full(SLOTS, STATE_SIZE, RewindBuffer::Mode::FULL);
+    RewindBuffer delta(SLOTS, STATE_SIZE, RewindBuffer::Mode::DELTA);
+    StateGenerator generator(STATE_SIZE);
+    std::vector<std::vector<uint8_t>> history;
+
+    for (int i = 0; i < 30; i++) {
+        history.push_back(generator.next());
+        full.push(history.back().data(), history.back().size());
+        delta.push(history.back().data(), history.back().size());
+    }
+
+    check(delta.getCapacityBytes() == full.getCapacityBytes(), "DELTA and FULL default to the same budget");
+    check(full.getValidCount() == SLOTS && delta.getValidCount() > SLOTS,
+        "DELTA keeps more states than slots in the same budget");
+    check(delta.getUsedBytes() < full.getUsedBytes(), "DELTA stores sparse changes as small deltas");
+    check(popAndVerify(delta, history, STATE_SIZE) > SLOTS, "DELTA pops its whole history exactly");
+}
+
+// A state size change can't be expressed as a delta, the older state is stored raw instead.
+void testStateSizeChange(RewindCodec::Type codec) {
+    constexpr size_t STATE_SIZE = 2048;
+    char name[128];
+
+    RewindBuffer buffer(16, STATE_SIZE, RewindBuffer::Mode::DELTA, 0, codec);
+    StateGenerator generator(1024);
+    std::vector<std::vector<uint8_t>> history;
+
+    for (int i = 0; i < 4; i++) {
+        history.push_back(generator.next());
+        buffer.push(history.back().data(), history.back().size());
+    }
+    generator.resize(STATE_SIZE);
+    for (int i = 0; i < 4; i++) {
+        history.push_back(generator.next());
+        buffer.push(history.back().data(), history.back().size());
+    }
+    generator.resize(512);
+    for (int i = 0; i < 4; i++) {
+        history.push_back(generator.next());
+        buffer.push(history.back().data(), history.back().size());
+    }
+
+    snprintf(name, sizeof(name), "DELTA/%s pops exactly across state size changes", codecName(codec));
+    check(popAndVerify(buffer, history, STATE_SIZE) == history.size(), name);
+}
+
+void testClear() {
+    RewindBuffer buffer(4, 64, RewindBuffer::Mode::DELTA);
+    std::vector<uint8_t> state(64, 1);
+    buffer.push(state.data(), state.size());
+    buffer.push(state.data(), state.size());
+    buffer.clear();
+
+    size_t size = 0;
+    check(buffer.getValidCount() == 0 && buffer.getUsedBytes() == 0 && !buffer.pop(state.data(), &size),
+        "Clear drops every state");
+}
+
+}
+
+int main() {
+    for (RewindBuffer::Mode mode : { RewindBuffer::Mode::FULL, RewindBuffer::Mode::DELTA }) {
+        for (RewindCodec::Type codec : { RewindCodec::Type::NONE, RewindCodec::Type::FAST_LZ, RewindCodec::Type::DEFLATE }) {
+            testRoundTrip(mode, codec);
+            testWraparound(mode, codec);
+        }
+    }
+
+    testEvictsOldestSlot();
+    testDeltaKeepsMoreHistory();
+    for (RewindCodec::Type codec : { RewindCodec::Type::NONE, RewindCodec::Type::FAST_LZ }) {
+        testStateSizeChange(codec);
+    }
+    testClear();
+
+    printf("\n%d failures\n", failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,187 @@
+#include "rewindbuffer.h"
+#include "rewindcodec.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace libretrodroid;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* name) {
+    printf("%s %s\n", condition ? "[PASS]" : "[FAIL]", name);
+    if (!condition) failures++;
+}
+
+const char* codecName(RewindCodec::Type type) {
+    return type == RewindCodec::Type::FAST_LZ ? "FAST_LZ" : "DEFLATE";
+}
+
+// Save states are mostly zeroed RAM with scattered values and repeated tiles.
+std::vector<uint8_t> compressibleData(size_t size) {
+    std::mt19937 random(11);
+    std::vector<uint8_t> data(size, 0);
+    for (size_t i = 0; i < size; i += 64) {
+        data[i] = (uint8_t) random();
+    }
+    for (size_t i = size / 2; i + 16 <= size; i += 16) {
+        memcpy(&data[i], "tile-0123456789a", 16);
+    }
+    return data;
+}
+
+std::vector<uint8_t> incompressibleData(size_t size) {
+    std::mt19937 random(13);
+    std::vector<uint8_t> data(size);
+    for (uint8_t& value : data) {
+        value = (uint8_t) random();
+    }
+    return data;
+}
+
+std::vector<uint8_t> compress(RewindCodec& codec, const std::vector<uint8_t>& input, size_t capacity) {
+    std::vector<uint8_t> output(capacity);
+    size_t size = codec.compress(input.data(), input.size(), output.data(), output.size());
+    output.resize(size);
+    return output;
+}
+
+// The payload is copied into an exactly sized buffer, so reads past it show up under a
+// sanitizer. The output is followed by guard bytes to catch writes past it.
+bool outputOverflowed = false;
+
+bool decompress(RewindCodec& codec, const std::vector<uint8_t>& payload, size_t outSize, std::vector<uint8_t>* output) {
+    constexpr size_t GUARD_SIZE = 64;
+    constexpr uint8_t GUARD = 0xA5;
+
+    std::vector<uint8_t> input(payload);
+    std::vector<uint8_t> buffer(outSize + GUARD_SIZE, GUARD);
+    bool result = codec.decompress(input.data(), input.size(), buffer.data(), outSize);
+
+    for (size_t i = outSize; i < buffer.size(); i++) {
+        outputOverflowed = outputOverflowed || buffer[i] != GUARD;
+    }
+    buffer.resize(outSize);
+    if (output) *output = buffer;
+    return result;
+}
+
+void testRoundTrip(RewindCodec::Type type) {
+    RewindCodec codec(type);
+    char name[128];
+
+    std::vector<uint8_t> compressible = compressibleData(64 * 1024);
+    std::vector<uint8_t> packed = compress(codec, compressible, compressible.size());
+    std::vector<uint8_t> unpacked;
+    snprintf(name, sizeof(name), "%s compresses state-like data", codecName(type));
+    check(!packed.empty() && packed.size() < compressible.size() / 4, name);
+    snprintf(name, sizeof(name), "%s round-trips compressible data", codecName(type));
+    check(decompress(codec, packed, compressible.size(), &unpacked) && unpacked == compressible, name);
+
+    std::vector<uint8_t> incompressible = incompressibleData(16 * 1024);
+    packed = compress(codec, incompressible, incompressible.size() * 2);
+    snprintf(name, sizeof(name), "%s round-trips incompressible data", codecName(type));
+    check(!packed.empty() && decompress(codec, packed, incompressible.size(), &unpacked) && unpacked == incompressible, name);
+
+    snprintf(name, sizeof(name), "%s fails when the output does not fit", codecName(type));
+    check(compress(codec, incompressible, incompressible.size() - 1).empty(), name);
+
+    std::vector<uint8_t> empty;
+    packed = compress(codec, empty, 64);
+    snprintf(name, sizeof(name), "%s round-trips empty input", codecName(type));
+    check(!packed.empty() && decompress(codec, packed, 0, &unpacked), name);
+
+    std::vector<uint8_t> small = { 1, 2, 3, 1, 2, 3, 1, 2, 3, 1, 2, 3, 1, 2, 3, 1, 2 };
+    packed = compress(codec, small, 64);
+    snprintf(name, sizeof(name), "%s round-trips inputs shorter than the match window", codecName(type));
+    check(!packed.empty() && decompress(codec, packed, small.size(), &unpacked) && unpacked == small, name);
+
+    snprintf(name, sizeof(name), "%s rejects a wrong output size", codecName(type));
+    packed = compress(codec, compressible, compressible.size());
+    check(!decompress(codec, packed, compressible.size() - 1, nullptr)
+        && !decompress(codec, packed, compressible.size() + 1, nullptr), name);
+}
+
+void testCorruptPayloads(RewindCodec::Type type) {
+    RewindCodec codec(type);
+    char name[128];
+
+    std::vector<uint8_t> input = compressibleData(8 * 1024);
+    std::vector<uint8_t> packed = compress(codec, input, input.size());
+
+    bool truncatedFails = true;
+    for (size_t size = 0; size < packed.size(); size++) {
+        std::vector<uint8_t> truncated(packed.begin(), packed.begin() + size);
+        truncatedFails = truncatedFails && !decompress(codec, truncated, input.size(), nullptr);
+    }
+    snprintf(name, sizeof(name), "%s rejects every truncated payload", codecName(type));
+    check(truncatedFails, name);
+
+    // FAST_LZ has no checksum, a flipped literal decodes to different bytes of the right size.
+    // DEFLATE does, so a flip is either rejected or lands in bits the decoder ignores.
+    bool flipsHandled = true;
+    for (size_t i = 0; i < packed.size(); i++) {
+        for (int bit = 0; bit < 8; bit++) {
+            std::vector<uint8_t> flipped(packed);
+            flipped[i] ^= (uint8_t) (1 << bit);
+
+            std::vector<uint8_t> output;
+            bool decoded = decompress(codec, flipped, input.size(), &output);
+            if (type == RewindCodec::Type::DEFLATE) {
+                flipsHandled = flipsHandled && (!decoded || output == input);
+            }
+        }
+    }
+    snprintf(name, sizeof(name), "%s handles every single bit flip", codecName(type));
+    check(flipsHandled, name);
+
+    std::vector<uint8_t> garbage = incompressibleData(4096);
+    snprintf(name, sizeof(name), "%s rejects random payloads", codecName(type));
+    check(!decompress(codec, garbage, input.size(), nullptr), name);
+
+    snprintf(name, sizeof(name), "%s never writes past the output", codecName(type));
+    check(!outputOverflowed, name);
+}
+
+// Entries are kept compressed only when that makes them smaller, otherwise they're stored raw.
+void testKeepsCompressedOnlyWhenSmaller(RewindCodec::Type type) {
+    char name[128];
+    constexpr size_t STATE_SIZE = 16 * 1024;
+
+    RewindBuffer buffer(4, STATE_SIZE, RewindBuffer::Mode::FULL, 0, type);
+    std::vector<uint8_t> incompressible = incompressibleData(STATE_SIZE);
+    std::vector<uint8_t> compressible = compressibleData(STATE_SIZE);
+
+    buffer.push(incompressible.data(), incompressible.size());
+    snprintf(name, sizeof(name), "%s stores incompressible states raw", codecName(type));
+    check(buffer.getUsedBytes() == STATE_SIZE, name);
+
+    buffer.push(compressible.data(), compressible.size());
+    snprintf(name, sizeof(name), "%s stores compressible states compressed", codecName(type));
+    check(buffer.getUsedBytes() < STATE_SIZE + STATE_SIZE / 4, name);
+
+    std::vector<uint8_t> output(STATE_SIZE);
+    size_t size = 0;
+    bool newest = buffer.pop(output.data(), &size) && size == STATE_SIZE && output == compressible;
+    bool oldest = buffer.pop(output.data(), &size) && size == STATE_SIZE && output == incompressible;
+    snprintf(name, sizeof(name), "%s pops both raw and compressed entries", codecName(type));
+    check(newest && oldest && !buffer.pop(output.data(), &size), name);
+}
+
+}
+
+int main() {
+    for (RewindCodec::Type type : { RewindCodec::Type::FAST_LZ, RewindCodec::Type::DEFLATE }) {
+        testRoundTrip(type);
+        testCorruptPayloads(type);
+        testKeepsCompressedOnlyWhenSmaller(type);
+    }
+
+    printf("\n%d failures\n", failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,103 @@
+#ifndef LIBRETRODROID_TESTS_OBOE_STUB_H
+#define LIBRETRODROID_TESTS_OBOE_STUB_H
+
+// Just enough of the oboe API for Audio to build on the host. Streams never call back, the
+// harness drives onAudioReady itself.
+
+#include <cstdint>
+#include <memory>
+
+namespace oboe {
+
+enum class Result { OK, ErrorDisconnected, ErrorUnimplemented };
+enum class DataCallbackResult { Continue, Stop };
+enum class Direction { Output, Input };
+enum class AudioFormat { I16, Float };
+enum class PerformanceMode { None, LowLatency };
+
+inline const char* convertToText(Result result) {
+    return result == Result::OK ? "OK" : "Error";
+}
+
+template<typename T>
+class ResultWithValue {
+public:
+    ResultWithValue(T value) : mValue(value), mError(Result::OK) { }
+    explicit operator bool() const { return mError == Result::OK; }
+    T value() const { return mValue; }
+
+private:
+    T mValue;
+    Result mError;
+};
+
+class AudioStream;
+
+class AudioStreamDataCallback {
+public:
+    virtual ~AudioStreamDataCallback() = default;
+    virtual DataCallbackResult onAudioReady(AudioStream* stream, void* audioData, int32_t numFrames) = 0;
+};
+
+class AudioStreamErrorCallback {
+public:
+    virtual ~AudioStreamErrorCallback() = default;
+    virtual void onErrorAfterClose(AudioStream* /* stream */, Result /* result */) { }
+};
+
+class AudioStream {
+public:
+    // Output stream parameters picked up by the next opened stream.
+    static inline int32_t defaultSampleRate = 48000;
+    static inline int32_t defaultFramesPerBurst = 192;
+
+    explicit AudioStream(AudioFormat format = AudioFormat::I16) : format(format) { }
+
+    int32_t getSampleRate() const { return sampleRate; }
+    AudioFormat getFormat() const { return format; }
+    int32_t getFramesPerBurst() const { return framesPerBurst; }
+    Result requestStart() { return Result::OK; }
+    Result requestStop() { return Result::OK; }
+    ResultWithValue<int32_t> getXRunCount() { return ResultWithValue<int32_t>(0); }
+
+private:
+    int32_t sampleRate = defaultSampleRate;
+    int32_t framesPerBurst = defaultFramesPerBurst;
+    AudioFormat format;
+};
+
+using ManagedStream = std::unique_ptr<AudioStream>;
+
+class AudioStreamBuilder {
+public:
+    // Picks between the AAudio and the legacy OpenSL ES paths of Audio.
+    static inline bool aaudioRecommended = true;
+
+    static bool isAAudioRecommended() { return aaudioRecommended; }
+
+    AudioStreamBuilder* setChannelCount(int) { return this; }
+    AudioStreamBuilder* setDirection(Direction) { return this; }
+    AudioStreamBuilder* setFormat(AudioFormat value) { format = value; return this; }
+    AudioStreamBuilder* setDataCallback(AudioStreamDataCallback*) { return this; }
+    AudioStreamBuilder* setErrorCallback(AudioStreamErrorCallback*) { return this; }
+    AudioStreamBuilder* setPerformanceMode(PerformanceMode) { return this; }
+    AudioStreamBuilder* setFramesPerCallback(int) { return this; }
+
+    Result openManagedStream(ManagedStream& stream) {
+        stream = std::make_unique<AudioStream>(format);
+        return Result::OK;
+    }
+
+private:
+    AudioFormat format = AudioFormat::I16;
+};
+
+class LatencyTuner {
+public:
+    explicit LatencyTuner(AudioStream&) { }
+    Result tune() { return Result::OK; }
+};
+
+}
+
+#endif //LIBRETRODROID_TESTS_OBOE_STUB_H
@@ -0,0 +1,115 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "audioring.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace libretrodroid {
+
+AudioRing::AudioRing(size_t capacityFrames) :
+    capacityFrames(std::max<size_t>(capacityFrames, 1)),
+    samples(new int16_t[this->capacityFrames * 2]()) { }
+
+const int16_t* AudioRing::frameAt(uint64_t position) const {
+    return &samples[(position % capacityFrames) * 2];
+}
+
+size_t AudioRing::write(const int16_t* data, size_t frames) {
+    uint64_t write = writePosition.load(std::memory_order_relaxed);
+
+    size_t space = capacityFrames - (write - cachedReadPosition);
+    if (space < frames) {
+        cachedReadPosition = readPosition.load(std::memory_order_acquire);
+        space = capacityFrames - (write - cachedReadPosition);
+    }
+
+    size_t toWrite = std::min(frames, space);
+    if (toWrite < frames) {
+        framesDropped.fetch_add(frames - toWrite, std::memory_order_relaxed);
+    }
+
+    size_t offset = write % capacityFrames;
+    size_t firstFrames = std::min(toWrite, capacityFrames - offset);
+    memcpy(&samples[offset * 2], data, firstFrames * 2 * sizeof(int16_t));
+    memcpy(&samples[0], data + firstFrames * 2, (toWrite - firstFrames) * 2 * sizeof(int16_t));
+
+    writePosition.store(write + toWrite, std::memory_order_release);
+    return toWrite;
+}
+
+AudioRing::Segments AudioRing::beginRead(size_t frames) {
+    uint64_t read = readPosition.load(std::memory_order_relaxed);
+    size_t available = writePosition.load(std::memory_order_acquire) - read;
+
+    if (available < minFillFrames.load(std::memory_order_relaxed)) {
+        minFillFrames.store(available, std::memory_order_relaxed);
+    }
+    if (available > maxFillFrames.load(std::memory_order_relaxed)) {
+        maxFillFrames.store(available, std::memory_order_relaxed);
+    }
+
+    size_t toRead = std::min(frames, available);
+    if (toRead < frames) {
+        framesMissing.fetch_add(frames - toRead, std::memory_order_relaxed);
+    }
+
+    size_t offset = read % capacityFrames;
+
+    Segments result;
+    result.first = &samples[offset * 2];
+    result.firstFrames = std::min(toRead, capacityFrames - offset);
+    result.second = &samples[0];
+    result.secondFrames = toRead - result.firstFrames;
+    return result;
+}
+
+void AudioRing::endRead(size_t frames) {
+    uint64_t read = readPosition.load(std::memory_order_relaxed);
+    readPosition.store(read + frames, std::memory_order_release);
+}
+
+size_t AudioRing::getFramesAvailable() const {
+    uint64_t read = readPosition.load(std::memory_order_acquire);
+    uint64_t write = writePosition.load(std::memory_order_acquire);
+    return write - read;
+}
+
+AudioRing::Stats AudioRing::getStats() const {
+    uint64_t read = readPosition.load(std::memory_order_acquire);
+    uint64_t write = writePosition.load(std::memory_order_acquire);
+    size_t minFill = minFillFrames.load(std::memory_order_relaxed);
+
+    Stats result {};
+    result.capacityFrames = capacityFrames;
+    result.fillFrames = write - read;
+    result.minFillFrames = minFill == SIZE_MAX ? result.fillFrames : minFill;
+    result.maxFillFrames = maxFillFrames.load(std::memory_order_relaxed);
+    result.framesWritten = write;
+    result.framesRead = read;
+    result.framesDropped = framesDropped.load(std::memory_order_relaxed);
+    result.framesMissing = framesMissing.load(std::memory_order_relaxed);
+    return result;
+}
+
+void AudioRing::resetStats() {
+    minFillFrames.store(SIZE_MAX, std::memory_order_relaxed);
+    maxFillFrames.store(0, std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,96 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_AUDIORING_H
+#define LIBRETRODROID_AUDIORING_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include "spscqueue.h"
+
+namespace libretrodroid {
+
+// Interleaved stereo ring between the emulation thread (producer) and the audio callback
+// (consumer). The producer keeps a private copy of the read position and only reloads the shared
+// one when the copy says it is out of room. The consumer loads the write position once per read,
+// which also gives exact fill statistics. Reads hand out the readable area as at most two
+// segments, which the resamplers consume in place.
+class AudioRing {
+public:
+    struct Segments {
+        const int16_t* first = nullptr;
+        size_t firstFrames = 0;
+        const int16_t* second = nullptr;
+        size_t secondFrames = 0;
+
+        size_t frames() const { return firstFrames + secondFrames; }
+    };
+
+    struct Stats {
+        size_t capacityFrames;
+        size_t fillFrames;
+        size_t minFillFrames;
+        size_t maxFillFrames;
+        uint64_t framesWritten;
+        uint64_t framesRead;
+        uint64_t framesDropped;
+        uint64_t framesMissing;
+    };
+
+    explicit AudioRing(size_t capacityFrames);
+
+    AudioRing(const AudioRing&) = delete;
+    AudioRing& operator=(const AudioRing&) = delete;
+
+    // Producer side. Returns the number of frames stored, frames which do not fit are dropped.
+    size_t write(const int16_t* data, size_t frames);
+
+    // Consumer side. beginRead exposes up to frames readable frames without consuming them,
+    // endRead releases the given amount once they have been used.
+    Segments beginRead(size_t frames);
+    void endRead(size_t frames);
+
+    size_t getCapacityFrames() const { return capacityFrames; }
+    size_t getFramesAvailable() const;
+
+    // Fill extremes are tracked from the consumer side, resetStats starts a new window.
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    const int16_t* frameAt(uint64_t position) const;
+
+private:
+    size_t capacityFrames;
+    std::unique_ptr<int16_t[]> samples;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> writePosition { 0 };
+    uint64_t cachedReadPosition = 0;
+    std::atomic<uint64_t> framesDropped { 0 };
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> readPosition { 0 };
+    std::atomic<uint64_t> framesMissing { 0 };
+    std::atomic<size_t> minFillFrames { SIZE_MAX };
+    std::atomic<size_t> maxFillFrames { 0 };
+};
+
+}
+
+#endif //LIBRETRODROID_AUDIORING_H
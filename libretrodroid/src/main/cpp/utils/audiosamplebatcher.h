@@ -0,0 +1,53 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_AUDIOSAMPLEBATCHER_H
+#define LIBRETRODROID_AUDIOSAMPLEBATCHER_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace libretrodroid {
+
+// Collects the stereo frames cores submit one at a time through retro_audio_sample_t, so the
+// audio path runs once per batch instead of once per frame.
+class AudioSampleBatcher {
+public:
+    // Enough for a frame of 48kHz audio at 12fps, callers flush earlier anyway.
+    static constexpr size_t CAPACITY_FRAMES = 4096;
+
+    // Returns true once the batch is full and has to be flushed before the next push.
+    bool push(int16_t left, int16_t right) {
+        samples[frames * 2] = left;
+        samples[frames * 2 + 1] = right;
+        return ++frames == CAPACITY_FRAMES;
+    }
+
+    const int16_t* data() const { return samples.data(); }
+    size_t size() const { return frames; }
+    bool empty() const { return frames == 0; }
+    void clear() { frames = 0; }
+
+private:
+    std::array<int16_t, CAPACITY_FRAMES * 2> samples;
+    size_t frames = 0;
+};
+
+}
+
+#endif //LIBRETRODROID_AUDIOSAMPLEBATCHER_H
@@ -0,0 +1,102 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bufferpool.h"
+
+#include <utility>
+
+namespace libretrodroid {
+
+BufferPool::Buffer::Buffer(BufferPool* pool, std::vector<int8_t> storage, size_t size)
+    : pool(pool), storage(std::move(storage)), bufferSize(size) { }
+
+BufferPool::Buffer::~Buffer() {
+    release();
+}
+
+BufferPool::Buffer::Buffer(Buffer&& other) noexcept
+    : pool(other.pool), storage(std::move(other.storage)), bufferSize(other.bufferSize) {
+    other.pool = nullptr;
+    other.bufferSize = 0;
+}
+
+BufferPool::Buffer& BufferPool::Buffer::operator=(Buffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        storage = std::move(other.storage);
+        bufferSize = other.bufferSize;
+        other.pool = nullptr;
+        other.bufferSize = 0;
+    }
+    return *this;
+}
+
+void BufferPool::Buffer::release() {
+    if (pool != nullptr) {
+        pool->recycle(std::move(storage));
+        pool = nullptr;
+    }
+    storage = std::vector<int8_t>();
+    bufferSize = 0;
+}
+
+BufferPool::BufferPool(size_t maxPooledBuffers) : maxPooledBuffers(maxPooledBuffers) { }
+
+BufferPool::Buffer BufferPool::acquire(size_t size) {
+    std::vector<int8_t> storage;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Prefer the smallest buffer which is already large enough, otherwise grow the largest.
+        auto best = freeBuffers.end();
+        for (auto it = freeBuffers.begin(); it != freeBuffers.end(); ++it) {
+            bool fits = it->size() >= size;
+            if (best == freeBuffers.end()) {
+                best = it;
+            } else if (fits && (best->size() < size || it->size() < best->size())) {
+                best = it;
+            } else if (!fits && best->size() < size && it->size() > best->size()) {
+                best = it;
+            }
+        }
+
+        if (best != freeBuffers.end()) {
+            storage = std::move(*best);
+            freeBuffers.erase(best);
+        }
+    }
+
+    if (storage.size() < size) {
+        storage.resize(size);
+    }
+    return Buffer(this, std::move(storage), size);
+}
+
+void BufferPool::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBuffers.clear();
+}
+
+void BufferPool::recycle(std::vector<int8_t> storage) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (freeBuffers.size() < maxPooledBuffers) {
+        freeBuffers.push_back(std::move(storage));
+    }
+}
+
+}
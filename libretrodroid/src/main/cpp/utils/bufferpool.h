@@ -0,0 +1,76 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_BUFFERPOOL_H
+#define LIBRETRODROID_BUFFERPOOL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace libretrodroid {
+
+// Keeps a few byte buffers around so repeated large exports (save states, memory dumps) don't
+// allocate on every call. Buffers are handed out as move-only leases which go back to the pool
+// when destroyed, and only grow.
+class BufferPool {
+public:
+    class Buffer {
+    public:
+        Buffer() = default;
+        ~Buffer();
+
+        Buffer(Buffer&& other) noexcept;
+        Buffer& operator=(Buffer&& other) noexcept;
+
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
+        int8_t* data() { return storage.data(); }
+        size_t size() const { return bufferSize; }
+
+    private:
+        friend class BufferPool;
+        Buffer(BufferPool* pool, std::vector<int8_t> storage, size_t size);
+
+        void release();
+
+        BufferPool* pool = nullptr;
+        std::vector<int8_t> storage;
+        size_t bufferSize = 0;
+    };
+
+    explicit BufferPool(size_t maxPooledBuffers = DEFAULT_MAX_POOLED_BUFFERS);
+
+    Buffer acquire(size_t size);
+    void clear();
+
+private:
+    void recycle(std::vector<int8_t> storage);
+
+private:
+    static constexpr size_t DEFAULT_MAX_POOLED_BUFFERS = 2;
+
+    std::mutex mutex;
+    std::vector<std::vector<int8_t>> freeBuffers;
+    size_t maxPooledBuffers;
+};
+
+}
+
+#endif //LIBRETRODROID_BUFFERPOOL_H
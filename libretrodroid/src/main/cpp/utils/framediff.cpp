@@ -0,0 +1,200 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "framediff.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace libretrodroid {
+
+// Eight independent 32 bit lanes, each word is mixed in as lane = (lane ^ word) * LANE_PRIME.
+// Both steps are bijective, so a changed word cannot be cancelled out by the words after it.
+static constexpr size_t LANES = 8;
+static constexpr size_t CHUNK_SIZE = LANES * sizeof(uint32_t);
+static constexpr uint32_t LANE_PRIME = 0x9E3779B1u;
+static constexpr uint64_t FOLD_PRIME = 0x100000001B3ull;
+
+static inline uint32_t loadWord(const uint8_t* data) {
+    uint32_t result;
+    std::memcpy(&result, data, sizeof(result));
+    return result;
+}
+
+static void initializeLanes(uint32_t* lanes) {
+    for (size_t i = 0; i < LANES; i++) {
+        lanes[i] = (uint32_t) (i + 1);
+    }
+}
+
+static void mixChunksScalar(uint32_t* lanes, const uint8_t* data, size_t chunks) {
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        for (size_t i = 0; i < LANES; i++) {
+            lanes[i] = (lanes[i] ^ loadWord(data + chunk * CHUNK_SIZE + i * sizeof(uint32_t))) * LANE_PRIME;
+        }
+    }
+}
+
+#if defined(__SSE2__) && !defined(__ARM_NEON)
+// SSE2 has no 32 bit low multiply, it is built from the two 32x32->64 ones.
+static inline __m128i multiplyLow32(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(
+        _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+        _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0))
+    );
+}
+#endif
+
+static void mixChunks(uint32_t* lanes, const uint8_t* data, size_t chunks) {
+#if defined(__ARM_NEON)
+    uint32x4_t low = vld1q_u32(lanes);
+    uint32x4_t high = vld1q_u32(lanes + 4);
+    uint32x4_t prime = vdupq_n_u32(LANE_PRIME);
+
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        const uint8_t* current = data + chunk * CHUNK_SIZE;
+        low = vmulq_u32(veorq_u32(low, vreinterpretq_u32_u8(vld1q_u8(current))), prime);
+        high = vmulq_u32(veorq_u32(high, vreinterpretq_u32_u8(vld1q_u8(current + 16))), prime);
+    }
+
+    vst1q_u32(lanes, low);
+    vst1q_u32(lanes + 4, high);
+#elif defined(__SSE2__)
+    __m128i low = _mm_loadu_si128((const __m128i*) lanes);
+    __m128i high = _mm_loadu_si128((const __m128i*) (lanes + 4));
+    __m128i prime = _mm_set1_epi32((int) LANE_PRIME);
+
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        const uint8_t* current = data + chunk * CHUNK_SIZE;
+        low = multiplyLow32(_mm_xor_si128(low, _mm_loadu_si128((const __m128i*) current)), prime);
+        high = multiplyLow32(_mm_xor_si128(high, _mm_loadu_si128((const __m128i*) (current + 16))), prime);
+    }
+
+    _mm_storeu_si128((__m128i*) lanes, low);
+    _mm_storeu_si128((__m128i*) (lanes + 4), high);
+#else
+    mixChunksScalar(lanes, data, chunks);
+#endif
+}
+
+// The end of a row which does not fill a chunk. Rows hold 16 or 32 bit pixels, so what is left
+// after the whole words is at most a half word.
+static void mixTail(uint32_t* lanes, const uint8_t* data, size_t size) {
+    size_t words = size / sizeof(uint32_t);
+    for (size_t i = 0; i < words; i++) {
+        lanes[i] = (lanes[i] ^ loadWord(data + i * sizeof(uint32_t))) * LANE_PRIME;
+    }
+
+    size_t remaining = size - words * sizeof(uint32_t);
+    if (remaining > 0) {
+        uint32_t last = 0;
+        std::memcpy(&last, data + words * sizeof(uint32_t), remaining);
+        lanes[words] = (lanes[words] ^ last) * LANE_PRIME;
+    }
+}
+
+static uint64_t foldLanes(const uint32_t* lanes) {
+    uint64_t result = 0;
+    for (size_t i = 0; i < LANES; i++) {
+        result = (result ^ lanes[i]) * FOLD_PRIME;
+    }
+    return result;
+}
+
+uint64_t FrameDiff::hashRows(const uint8_t* data, size_t rowSize, size_t pitch, unsigned int rows) {
+    uint32_t lanes[LANES];
+    initializeLanes(lanes);
+
+    size_t chunks = rowSize / CHUNK_SIZE;
+    for (unsigned int row = 0; row < rows; row++) {
+        const uint8_t* current = data + row * pitch;
+        mixChunks(lanes, current, chunks);
+        mixTail(lanes, current + chunks * CHUNK_SIZE, rowSize - chunks * CHUNK_SIZE);
+    }
+
+    return foldLanes(lanes);
+}
+
+uint64_t FrameDiff::hashRowsScalar(const uint8_t* data, size_t rowSize, size_t pitch, unsigned int rows) {
+    uint32_t lanes[LANES];
+    initializeLanes(lanes);
+
+    size_t chunks = rowSize / CHUNK_SIZE;
+    for (unsigned int row = 0; row < rows; row++) {
+        const uint8_t* current = data + row * pitch;
+        mixChunksScalar(lanes, current, chunks);
+        mixTail(lanes, current + chunks * CHUNK_SIZE, rowSize - chunks * CHUNK_SIZE);
+    }
+
+    return foldLanes(lanes);
+}
+
+const std::vector<FrameDiff::Band>& FrameDiff::update(
+    const void* data,
+    unsigned int width,
+    unsigned int height,
+    size_t pitch,
+    unsigned int bytesPerPixel
+) {
+    size_t newRowSize = (size_t) width * bytesPerPixel;
+    size_t bandCount = (height + BAND_ROWS - 1) / BAND_ROWS;
+
+    bool reset = !valid || width != this->width || height != this->height || newRowSize != rowSize;
+    if (reset) {
+        hashes.assign(bandCount, 0);
+        this->width = width;
+        this->height = height;
+        rowSize = newRowSize;
+        valid = true;
+    }
+
+    dirtyBands.clear();
+    auto source = static_cast<const uint8_t*>(data);
+
+    for (size_t band = 0; band < bandCount; band++) {
+        auto firstRow = (unsigned int) (band * BAND_ROWS);
+        unsigned int rows = std::min(BAND_ROWS, height - firstRow);
+
+        uint64_t hash = hashRows(source + firstRow * pitch, rowSize, pitch, rows);
+        if (!reset && hash == hashes[band]) {
+            continue;
+        }
+        hashes[band] = hash;
+
+        if (!dirtyBands.empty() && dirtyBands.back().firstRow + dirtyBands.back().rows == firstRow) {
+            dirtyBands.back().rows += rows;
+        } else {
+            dirtyBands.push_back({ firstRow, rows });
+        }
+    }
+
+    return dirtyBands;
+}
+
+void FrameDiff::invalidate() {
+    valid = false;
+}
+
+}
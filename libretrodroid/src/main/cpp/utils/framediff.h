@@ -0,0 +1,69 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_FRAMEDIFF_H
+#define LIBRETRODROID_FRAMEDIFF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace libretrodroid {
+
+// Finds which parts of a software frame changed since the previous one, so identical frames
+// are not uploaded again and changed ones only upload their dirty rows. Frames are split in
+// bands of BAND_ROWS rows, each one keeps a hash of its pixels. Row padding is ignored.
+class FrameDiff {
+public:
+    static constexpr unsigned int BAND_ROWS = 16;
+
+    struct Band {
+        unsigned int firstRow;
+        unsigned int rows;
+    };
+
+    // Returns the changed row ranges, adjacent bands are merged. The whole frame is reported
+    // after a size change or an invalidate.
+    const std::vector<Band>& update(
+        const void* data,
+        unsigned int width,
+        unsigned int height,
+        size_t pitch,
+        unsigned int bytesPerPixel
+    );
+
+    // To be called whenever the destination lost its content, like a reallocated texture.
+    void invalidate();
+
+    // A change to a single word always changes the hash, the default kernel uses NEON or SSE2
+    // and returns the same values as the scalar one.
+    static uint64_t hashRows(const uint8_t* data, size_t rowSize, size_t pitch, unsigned int rows);
+    static uint64_t hashRowsScalar(const uint8_t* data, size_t rowSize, size_t pitch, unsigned int rows);
+
+private:
+    std::vector<uint64_t> hashes;
+    std::vector<Band> dirtyBands;
+
+    unsigned int width = 0;
+    unsigned int height = 0;
+    size_t rowSize = 0;
+    bool valid = false;
+};
+
+}
+
+#endif //LIBRETRODROID_FRAMEDIFF_H
@@ -0,0 +1,49 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frametimehistogram.h"
+
+namespace libretrodroid {
+
+void FrameTimeHistogram::record(std::chrono::steady_clock::duration duration) {
+    int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+
+    size_t bucket = 0;
+    int64_t limit = FIRST_BUCKET_LIMIT_US;
+    while (bucket < BUCKET_COUNT - 1 && micros >= limit) {
+        limit *= 2;
+        bucket++;
+    }
+
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void FrameTimeHistogram::reset() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::array<uint64_t, FrameTimeHistogram::BUCKET_COUNT> FrameTimeHistogram::getBuckets() const {
+    std::array<uint64_t, BUCKET_COUNT> result {};
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        result[i] = buckets[i].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+}
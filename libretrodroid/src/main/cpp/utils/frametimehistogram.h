@@ -0,0 +1,62 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_FRAMETIMEHISTOGRAM_H
+#define LIBRETRODROID_FRAMETIMEHISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace libretrodroid {
+
+// Power-of-two histogram of durations. Bucket i counts samples shorter than 2^i * 125us, the last
+// bucket collects everything above ~32ms. Samples are recorded on the emulation thread and can be
+// read from any thread.
+class FrameTimeHistogram {
+public:
+    static constexpr size_t BUCKET_COUNT = 10;
+    static constexpr int64_t FIRST_BUCKET_LIMIT_US = 125;
+
+    void record(std::chrono::steady_clock::duration duration);
+    void reset();
+
+    std::array<uint64_t, BUCKET_COUNT> getBuckets() const;
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets {};
+};
+
+// Records the lifetime of the enclosing scope into a histogram.
+class ScopedFrameTimer {
+public:
+    explicit ScopedFrameTimer(FrameTimeHistogram& histogram)
+        : histogram(histogram), start(std::chrono::steady_clock::now()) { }
+
+    ~ScopedFrameTimer() {
+        histogram.record(std::chrono::steady_clock::now() - start);
+    }
+
+private:
+    FrameTimeHistogram& histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+}
+
+#endif //LIBRETRODROID_FRAMETIMEHISTOGRAM_H
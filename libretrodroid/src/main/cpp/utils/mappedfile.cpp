@@ -0,0 +1,110 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "mappedfile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../log.h"
+
+namespace libretrodroid {
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::string& filePath) {
+    int fileDescriptor = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0) {
+        LOGE("Cannot open game file %s: %s", filePath.c_str(), strerror(errno));
+        throw std::runtime_error("Cannot open game file");
+    }
+    return open(fileDescriptor);
+}
+
+std::unique_ptr<MappedFile> MappedFile::open(int fileDescriptor) {
+    auto result = map(fileDescriptor);
+    if (!result) {
+        result = read(fileDescriptor);
+    }
+    close(fileDescriptor);
+
+    if (!result) {
+        throw std::runtime_error("Cannot read game file");
+    }
+    return result;
+}
+
+MappedFile::~MappedFile() {
+    if (mapping != nullptr) {
+        munmap(mapping, length);
+    }
+}
+
+const void* MappedFile::data() const {
+    return mapping != nullptr ? mapping : buffer.data();
+}
+
+std::unique_ptr<MappedFile> MappedFile::map(int fileDescriptor) {
+    struct stat fileStat {};
+    if (fstat(fileDescriptor, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size <= 0) {
+        return nullptr;
+    }
+
+    size_t size = fileStat.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+        LOGI("Cannot map game file, reading it instead: %s", strerror(errno));
+        return nullptr;
+    }
+
+    // Cores usually go through the whole ROM right away, so start reading it in.
+    madvise(mapping, size, MADV_WILLNEED);
+
+    auto result = std::unique_ptr<MappedFile>(new MappedFile());
+    result->mapping = mapping;
+    result->length = size;
+    return result;
+}
+
+std::unique_ptr<MappedFile> MappedFile::read(int fileDescriptor) {
+    auto result = std::unique_ptr<MappedFile>(new MappedFile());
+
+    lseek(fileDescriptor, 0, SEEK_SET);
+
+    // The size may be unknown for non regular files, so read until the end.
+    char chunk[64 * 1024];
+    while (true) {
+        ssize_t count = ::read(fileDescriptor, chunk, sizeof(chunk));
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            LOGE("Cannot read game file: %s", strerror(errno));
+            return nullptr;
+        }
+        if (count == 0) {
+            break;
+        }
+        result->buffer.insert(result->buffer.end(), chunk, chunk + count);
+    }
+
+    result->length = result->buffer.size();
+    return result;
+}
+
+}
@@ -0,0 +1,63 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_MAPPEDFILE_H
+#define LIBRETRODROID_MAPPEDFILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libretrodroid {
+
+// Read-only content of a game file, kept alive for as long as the core may access it.
+// Files are mapped copy-on-write, so pages are only read from storage when touched and the ROM
+// does not cost its full size in heap. Cores which patch the data in place (byte swapping for
+// instance) only copy the pages they modify. When a descriptor cannot be mapped (pipes, some
+// content providers) the content is read into memory instead.
+class MappedFile {
+public:
+    static std::unique_ptr<MappedFile> open(const std::string& filePath);
+
+    // Takes ownership of the descriptor, which is closed before returning.
+    static std::unique_ptr<MappedFile> open(int fileDescriptor);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const void* data() const;
+    size_t size() const { return length; }
+    bool isMapped() const { return mapping != nullptr; }
+
+private:
+    MappedFile() = default;
+
+    static std::unique_ptr<MappedFile> map(int fileDescriptor);
+    static std::unique_ptr<MappedFile> read(int fileDescriptor);
+
+private:
+    void* mapping = nullptr;
+    size_t length = 0;
+    std::vector<char> buffer;
+};
+
+}
+
+#endif //LIBRETRODROID_MAPPEDFILE_H
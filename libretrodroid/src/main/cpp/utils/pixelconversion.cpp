@@ -0,0 +1,156 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pixelconversion.h"
+
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace libretrodroid {
+
+size_t PixelConversion::bytesPerPixel(Type type) {
+    switch (type) {
+        case Type::COPY_32:
+        case Type::SWAP_RED_BLUE_32:
+            return 4;
+        case Type::COPY_16:
+        case Type::RGB1555_TO_RGB565:
+        default:
+            return 2;
+    }
+}
+
+void PixelConversion::convertRows(
+    Type type,
+    const void* source,
+    size_t sourcePitch,
+    void* destination,
+    size_t destinationPitch,
+    unsigned int width,
+    unsigned int height
+) {
+    size_t rowSize = width * bytesPerPixel(type);
+    size_t pixels = width;
+    size_t rows = height;
+
+    if (sourcePitch == rowSize && destinationPitch == rowSize) {
+        pixels *= height;
+        rows = 1;
+    }
+
+    auto sourceRow = static_cast<const uint8_t*>(source);
+    auto destinationRow = static_cast<uint8_t*>(destination);
+
+    for (size_t row = 0; row < rows; row++) {
+        switch (type) {
+            case Type::SWAP_RED_BLUE_32:
+                swapRedBlue32((const uint32_t*) sourceRow, (uint32_t*) destinationRow, pixels);
+                break;
+            case Type::RGB1555_TO_RGB565:
+                rgb1555ToRGB565((const uint16_t*) sourceRow, (uint16_t*) destinationRow, pixels);
+                break;
+            case Type::COPY_16:
+            case Type::COPY_32:
+            default:
+                std::memcpy(destinationRow, sourceRow, pixels * bytesPerPixel(type));
+                break;
+        }
+        sourceRow += sourcePitch;
+        destinationRow += destinationPitch;
+    }
+}
+
+void PixelConversion::swapRedBlue32(const uint32_t* source, uint32_t* destination, size_t pixels) {
+    size_t i = 0;
+
+#if defined(__ARM_NEON)
+    // De-interleaving loads split the four channels, the swap is just a register rename.
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x4_t channels = vld4q_u8((const uint8_t*) (source + i));
+        uint8x16_t blue = channels.val[0];
+        channels.val[0] = channels.val[2];
+        channels.val[2] = blue;
+        vst4q_u8((uint8_t*) (destination + i), channels);
+    }
+#elif defined(__SSSE3__)
+    // A single byte shuffle per four pixels. With plain SSE2 the masks and shifts are slower than
+    // the scalar loop, which is used instead.
+    const __m128i swapMask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i pixel = _mm_loadu_si128((const __m128i*) (source + i));
+        _mm_storeu_si128((__m128i*) (destination + i), _mm_shuffle_epi8(pixel, swapMask));
+    }
+#endif
+
+    swapRedBlue32Scalar(source + i, destination + i, pixels - i);
+}
+
+void PixelConversion::rgb1555ToRGB565(const uint16_t* source, uint16_t* destination, size_t pixels) {
+    size_t i = 0;
+
+#if defined(__ARM_NEON)
+    const uint16x8_t blueMask = vdupq_n_u16(0x1F);
+    const uint16x8_t redGreenMask = vdupq_n_u16(0x7FE0);
+
+    for (; i + 8 <= pixels; i += 8) {
+        uint16x8_t pixel = vld1q_u16(source + i);
+        uint16x8_t result = vorrq_u16(
+            vandq_u16(pixel, blueMask),
+            vshlq_n_u16(vandq_u16(pixel, redGreenMask), 1)
+        );
+        vst1q_u16(destination + i, result);
+    }
+#elif defined(__SSE2__)
+    const __m128i blueMask = _mm_set1_epi16(0x1F);
+    const __m128i redGreenMask = _mm_set1_epi16(0x7FE0);
+
+    for (; i + 8 <= pixels; i += 8) {
+        __m128i pixel = _mm_loadu_si128((const __m128i*) (source + i));
+        __m128i result = _mm_or_si128(
+            _mm_and_si128(pixel, blueMask),
+            _mm_slli_epi16(_mm_and_si128(pixel, redGreenMask), 1)
+        );
+        _mm_storeu_si128((__m128i*) (destination + i), result);
+    }
+#endif
+
+    rgb1555ToRGB565Scalar(source + i, destination + i, pixels - i);
+}
+
+void PixelConversion::swapRedBlue32Scalar(const uint32_t* source, uint32_t* destination, size_t pixels) {
+    for (size_t i = 0; i < pixels; i++) {
+        uint32_t pixel = source[i];
+        destination[i] = (pixel & 0xFF00FF00u) | ((pixel >> 16) & 0xFFu) | ((pixel & 0xFFu) << 16);
+    }
+}
+
+void PixelConversion::rgb1555ToRGB565Scalar(const uint16_t* source, uint16_t* destination, size_t pixels) {
+    for (size_t i = 0; i < pixels; i++) {
+        uint16_t pixel = source[i];
+        destination[i] = (uint16_t) ((pixel & 0x1Fu) | ((pixel & 0x7FE0u) << 1));
+    }
+}
+
+}
@@ -0,0 +1,66 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_PIXELCONVERSION_H
+#define LIBRETRODROID_PIXELCONVERSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace libretrodroid {
+
+// Converts software framebuffers into the layout uploaded to textures, always into a separate
+// destination so the core memory is never touched. The default kernels use NEON, SSSE3 or SSE2
+// when the target has them, the scalar ones are the reference they are tested against.
+class PixelConversion {
+public:
+    enum class Type {
+        COPY_16,
+        COPY_32,
+
+        // XRGB8888 is stored B, G, R, X in memory. Swapping red and blue gives RGBA8888 for
+        // renderers which cannot swizzle on the GPU. X ends up as alpha.
+        SWAP_RED_BLUE_32,
+
+        // Green is widened to six bits, its lowest bit stays zero.
+        RGB1555_TO_RGB565,
+    };
+
+    static size_t bytesPerPixel(Type type);
+
+    // Converts width x height pixels. Pitches are in bytes and rows are processed in a single run
+    // when both sides are tightly packed.
+    static void convertRows(
+        Type type,
+        const void* source,
+        size_t sourcePitch,
+        void* destination,
+        size_t destinationPitch,
+        unsigned int width,
+        unsigned int height
+    );
+
+    static void swapRedBlue32(const uint32_t* source, uint32_t* destination, size_t pixels);
+    static void rgb1555ToRGB565(const uint16_t* source, uint16_t* destination, size_t pixels);
+
+    static void swapRedBlue32Scalar(const uint32_t* source, uint32_t* destination, size_t pixels);
+    static void rgb1555ToRGB565Scalar(const uint16_t* source, uint16_t* destination, size_t pixels);
+};
+
+}
+
+#endif //LIBRETRODROID_PIXELCONVERSION_H
@@ -0,0 +1,73 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_SPSCQUEUE_H
+#define LIBRETRODROID_SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace libretrodroid {
+
+// Cache line size used to keep producer and consumer indices from sharing a line.
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+template<typename T>
+class SPSCQueue {
+public:
+    explicit SPSCQueue(size_t capacity) : items(capacity + 1) { }
+
+    bool push(const T& item) {
+        size_t tail = writeIndex.load(std::memory_order_relaxed);
+        size_t next = (tail + 1) % items.size();
+        if (next == readIndex.load(std::memory_order_acquire)) {
+            return false;
+        }
+        items[tail] = item;
+        writeIndex.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        size_t head = readIndex.load(std::memory_order_relaxed);
+        if (head == writeIndex.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[head];
+        readIndex.store((head + 1) % items.size(), std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return readIndex.load(std::memory_order_acquire) == writeIndex.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return items.size() - 1;
+    }
+
+private:
+    std::vector<T> items;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> writeIndex { 0 };
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> readIndex { 0 };
+};
+
+}
+
+#endif //LIBRETRODROID_SPSCQUEUE_H
@@ -275,13 +275,15 @@ Video::Video(
     bool skipDuplicateFrames,
     bool immersiveModeEnabled,
     Rect viewportRect,
-    ImmersiveMode::Config immersiveModeConfig
+    ImmersiveMode::Config immersiveModeConfig,
+    VideoTelemetry& telemetry
 ) :
     requestedShaderConfig(std::move(shaderConfig)),
     skipDuplicateFrames(skipDuplicateFrames),
     immersiveModeEnabled(immersiveModeEnabled),
     immersiveMode(immersiveModeConfig),
-    videoLayout(bottomLeftOrigin, rotation, viewportRect) {
+    videoLayout(bottomLeftOrigin, rotation, viewportRect),
+    telemetry(telemetry) {
 
     printGLString("Version", GL_VERSION);
     printGLString("Vendor", GL_VENDOR);
@@ -329,7 +331,7 @@ void Video::initializeRenderer(RenderingOptions renderingOptions) {
     auto shaders = ShaderManager::getShader(requestedShaderConfig);
 
     if (renderingOptions.hardwareAccelerated) {
-        renderer = new FramebufferRenderer(
+        renderer = std::make_unique<FramebufferRenderer>(
             renderingOptions.width,
             renderingOptions.height,
             renderingOptions.useDepth,
@@ -338,9 +340,9 @@ void Video::initializeRenderer(RenderingOptions renderingOptions) {
         );
     } else {
         if (renderingOptions.openglESVersion >= 3) {
-            renderer = new ImageRendererES3();
+            renderer = std::make_unique<ImageRendererES3>(telemetry);
         } else {
-            renderer = new ImageRendererES2();
+            renderer = std::make_unique<ImageRendererES2>(telemetry);
         }
     }
 
@@ -21,12 +21,14 @@
 #include <GLES2/gl2.h>
 #include <optional>
 #include <array>
+#include <memory>
 
 #include "renderers/renderer.h"
 #include "shadermanager.h"
 #include "utils/rect.h"
 #include "immersivemode.h"
 #include "videolayout.h"
+#include "videotelemetry.h"
 
 namespace libretrodroid {
 
@@ -61,7 +63,8 @@ public:
         bool skipDuplicateFrames,
         bool immersiveMode,
         Rect viewportRect,
-        ImmersiveMode::Config immersiveModeConfig
+        ImmersiveMode::Config immersiveModeConfig,
+        VideoTelemetry& telemetry
     );
 
     VideoLayout& getLayout() { return videoLayout; }
@@ -115,8 +118,9 @@ private:
     bool immersiveModeEnabled = false;
     ImmersiveMode immersiveMode;
     VideoLayout videoLayout;
+    VideoTelemetry& telemetry;
 
-    Renderer* renderer;
+    std::unique_ptr<Renderer> renderer;
 };
 
 }
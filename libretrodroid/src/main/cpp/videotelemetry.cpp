@@ -0,0 +1,68 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "videotelemetry.h"
+
+namespace libretrodroid {
+
+void VideoTelemetry::recordUpload(bool viaPixelBuffer, size_t bytes, bool partial) {
+    uploads.fetch_add(1, std::memory_order_relaxed);
+    if (viaPixelBuffer) {
+        pixelBufferUploads.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (partial) {
+        partialUploads.fetch_add(1, std::memory_order_relaxed);
+    }
+    bytesUploaded.fetch_add(bytes, std::memory_order_relaxed);
+    lastFrameBytesUploaded.store(bytes, std::memory_order_relaxed);
+}
+
+void VideoTelemetry::recordSkippedUpload() {
+    skippedUploads.fetch_add(1, std::memory_order_relaxed);
+    lastFrameBytesUploaded.store(0, std::memory_order_relaxed);
+}
+
+void VideoTelemetry::recordFenceWait(uint64_t nanos) {
+    fenceWaits.fetch_add(1, std::memory_order_relaxed);
+    fenceWaitNanos.fetch_add(nanos, std::memory_order_relaxed);
+}
+
+VideoTelemetry::Snapshot VideoTelemetry::getSnapshot() const {
+    Snapshot result {};
+    result.uploads = uploads.load(std::memory_order_relaxed);
+    result.pixelBufferUploads = pixelBufferUploads.load(std::memory_order_relaxed);
+    result.fenceWaits = fenceWaits.load(std::memory_order_relaxed);
+    result.fenceWaitNanos = fenceWaitNanos.load(std::memory_order_relaxed);
+    result.skippedUploads = skippedUploads.load(std::memory_order_relaxed);
+    result.partialUploads = partialUploads.load(std::memory_order_relaxed);
+    result.bytesUploaded = bytesUploaded.load(std::memory_order_relaxed);
+    result.lastFrameBytesUploaded = lastFrameBytesUploaded.load(std::memory_order_relaxed);
+    return result;
+}
+
+void VideoTelemetry::reset() {
+    uploads.store(0, std::memory_order_relaxed);
+    pixelBufferUploads.store(0, std::memory_order_relaxed);
+    fenceWaits.store(0, std::memory_order_relaxed);
+    fenceWaitNanos.store(0, std::memory_order_relaxed);
+    skippedUploads.store(0, std::memory_order_relaxed);
+    partialUploads.store(0, std::memory_order_relaxed);
+    bytesUploaded.store(0, std::memory_order_relaxed);
+    lastFrameBytesUploaded.store(0, std::memory_order_relaxed);
+}
+
+}
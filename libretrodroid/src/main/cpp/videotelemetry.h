@@ -0,0 +1,67 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBRETRODROID_VIDEOTELEMETRY_H
+#define LIBRETRODROID_VIDEOTELEMETRY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace libretrodroid {
+
+// Counters for the software frame upload path. Recorded on the GL thread, readable from any
+// thread, and kept across games until reset like AudioTelemetry.
+class VideoTelemetry {
+public:
+    struct Snapshot {
+        uint64_t uploads;
+        uint64_t pixelBufferUploads;
+
+        // Uploads which found their pixel buffer still in use by the GPU and had to wait.
+        uint64_t fenceWaits;
+        uint64_t fenceWaitNanos;
+
+        // Frames identical to the previous one are skipped, changed ones may only upload the
+        // rows which differ.
+        uint64_t skippedUploads;
+        uint64_t partialUploads;
+        uint64_t bytesUploaded;
+        uint64_t lastFrameBytesUploaded;
+    };
+
+    void recordUpload(bool viaPixelBuffer, size_t bytes, bool partial);
+    void recordSkippedUpload();
+    void recordFenceWait(uint64_t nanos);
+
+    Snapshot getSnapshot() const;
+    void reset();
+
+private:
+    std::atomic<uint64_t> uploads { 0 };
+    std::atomic<uint64_t> pixelBufferUploads { 0 };
+    std::atomic<uint64_t> fenceWaits { 0 };
+    std::atomic<uint64_t> fenceWaitNanos { 0 };
+    std::atomic<uint64_t> skippedUploads { 0 };
+    std::atomic<uint64_t> partialUploads { 0 };
+    std::atomic<uint64_t> bytesUploaded { 0 };
+    std::atomic<uint64_t> lastFrameBytesUploaded { 0 };
+};
+
+}
+
+#endif //LIBRETRODROID_VIDEOTELEMETRY_H
@@ -34,6 +34,8 @@ import androidx.lifecycle.OnLifecycleEvent
 import androidx.lifecycle.coroutineScope
 import com.swordfish.libretrodroid.KtUtils.awaitUninterruptibly
 import com.swordfish.libretrodroid.gamepad.GamepadsManager
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 import java.util.*
 import java.util.concurrent.CountDownLatch
 import javax.microedition.khronos.egl.EGLConfig
@@ -53,6 +55,24 @@ class GLRetroView(
         LibretroDroid.setAudioEnabled(value)
     }
 
+    var audioResampler: Int by Delegates.observable(LibretroDroid.AUDIO_RESAMPLER_LINEAR) { _, _, value ->
+        LibretroDroid.setAudioResampler(value)
+    }
+
+    var audioSync: Boolean by Delegates.observable(false) { _, _, value ->
+        LibretroDroid.setAudioSync(value)
+    }
+
+    var audioDSPConfig: String? by Delegates.observable<String?>(null) { _, _, value ->
+        runOnGLThread {
+            LibretroDroid.setAudioDSP(value)
+        }
+    }
+
+    var fastForwardAudio: Int by Delegates.observable(LibretroDroid.FAST_FORWARD_AUDIO_PITCH) { _, _, value ->
+        LibretroDroid.setFastForwardAudio(value)
+    }
+
     var frameSpeed: Int by Delegates.observable(1) { _, _, value ->
         LibretroDroid.setFrameSpeed(value)
     }
@@ -137,7 +157,8 @@ class GLRetroView(
             data.enableMicrophone,
             data.skipDuplicateFrames,
             data.immersiveMode,
-            getDeviceLanguage()
+            getDeviceLanguage(),
+            context.cacheDir.absolutePath
         )
         LibretroDroid.setRumbleEnabled(data.rumbleEventsEnabled)
     }
@@ -191,6 +212,15 @@ class GLRetroView(
     fun serializeState(): ByteArray = runOnGLThread {
         LibretroDroid.serializeState()
     }
+
+    fun getSerializeSize(): Int = runOnGLThread {
+        LibretroDroid.getSerializeSize()
+    }
+
+    /** Serializes into a reusable direct buffer, returns the state size or -1. */
+    fun serializeStateInto(buffer: ByteBuffer): Int = runOnGLThread {
+        LibretroDroid.serializeStateInto(buffer)
+    }
     fun setCheat(index : Int, enable : Boolean, code : String) = runOnGLThread {
         LibretroDroid.setCheat(index, enable, code)
     }
@@ -215,6 +245,38 @@ class GLRetroView(
         LibretroDroid.getMemoryData(memoryType)
     }
 
+    /** Copies a memory region into a reusable direct buffer, returns its size or -1. */
+    fun getMemoryDataInto(memoryType: Int, buffer: ByteBuffer): Int = runOnGLThread {
+        LibretroDroid.getMemoryDataInto(memoryType, buffer)
+    }
+
+    fun startSRAMMonitor(pageSize: Int = 0) = runOnGLThread {
+        LibretroDroid.startSRAMMonitor(pageSize)
+    }
+
+    fun stopSRAMMonitor() = runOnGLThread {
+        LibretroDroid.stopSRAMMonitor()
+    }
+
+    fun getSRAMDirtyPages(): IntArray = runOnGLThread {
+        LibretroDroid.getSRAMDirtyPages()
+    }
+
+    fun flushSRAM(fd: Int): Long = runOnGLThread {
+        LibretroDroid.flushSRAM(fd)
+    }
+
+    fun getMemoryView(memoryType: Int): MemoryView? = runOnGLThread {
+        val generation = LibretroDroid.getMemoryGeneration()
+        LibretroDroid.getMemoryView(memoryType)?.let {
+            MemoryView(it.order(ByteOrder.LITTLE_ENDIAN), generation)
+        }
+    }
+
+    fun getMemoryDescriptors(): Array<MemoryDescriptor> = runOnGLThread {
+        LibretroDroid.getMemoryDescriptors()
+    }
+
     fun getMemorySize(memoryType: Int): Int = runOnGLThread {
         LibretroDroid.getMemorySize(memoryType)
     } ?: 0
@@ -261,8 +323,30 @@ class GLRetroView(
     fun getCurrentDisk() = runOnGLThread { LibretroDroid.currentDisk() }
     fun changeDisk(index: Int) = runOnGLThread { LibretroDroid.changeDisk(index) }
 
-    fun initRewindBuffer(slotCount: Int, maxStateSize: Int) = runOnGLThread {
-        LibretroDroid.initRewindBuffer(slotCount, maxStateSize)
+    fun setRunAhead(frames: Int, useSecondInstance: Boolean = false) = runOnGLThread {
+        LibretroDroid.setRunAhead(frames, useSecondInstance)
+    }
+
+    fun isRunAheadSecondInstanceFailed(): Boolean = runOnGLThread {
+        LibretroDroid.isRunAheadSecondInstanceFailed()
+    }
+
+    fun setPreemptiveFrames(frames: Int) = runOnGLThread {
+        LibretroDroid.setPreemptiveFrames(frames)
+    }
+
+    fun getPreemptiveFramesStats(): LongArray = runOnGLThread {
+        LibretroDroid.getPreemptiveFramesStats()
+    }
+
+    fun initRewindBuffer(
+        slotCount: Int,
+        maxStateSize: Int,
+        mode: Int = LibretroDroid.REWIND_MODE_FULL,
+        budgetBytes: Long = 0,
+        codec: Int = LibretroDroid.REWIND_CODEC_NONE
+    ) = runOnGLThread {
+        LibretroDroid.initRewindBuffer(slotCount, maxStateSize, mode, budgetBytes, codec)
     }
 
     fun captureRewindState(): Boolean = runOnGLThread {
@@ -285,6 +369,30 @@ class GLRetroView(
 
     fun getRewindBufferValidCount(): Int = LibretroDroid.getRewindBufferValidCount()
 
+    fun getRewindBufferUsedBytes(): Long = LibretroDroid.getRewindBufferUsedBytes()
+
+    fun getRewindBufferCapacityBytes(): Long = LibretroDroid.getRewindBufferCapacityBytes()
+
+    fun setRewindCaptureAsync(enabled: Boolean) = runOnGLThread {
+        LibretroDroid.setRewindCaptureAsync(enabled)
+    }
+
+    fun getStepTimeHistogram(): LongArray = LibretroDroid.getStepTimeHistogram()
+
+    fun getRewindCaptureTimeHistogram(): LongArray = LibretroDroid.getRewindCaptureTimeHistogram()
+
+    fun resetFrameTimeHistograms() = LibretroDroid.resetFrameTimeHistograms()
+
+    fun getAudioTelemetry(): LongArray = LibretroDroid.getAudioTelemetry()
+
+    fun getAudioControllerTrace(): FloatArray = LibretroDroid.getAudioControllerTrace()
+
+    fun resetAudioTelemetry() = LibretroDroid.resetAudioTelemetry()
+
+    fun getVideoTelemetry(): LongArray = LibretroDroid.getVideoTelemetry()
+
+    fun resetVideoTelemetry() = LibretroDroid.resetVideoTelemetry()
+
     private fun getGLESVersion(context: Context): Int {
         val activityManager = context.getSystemService(Context.ACTIVITY_SERVICE) as ActivityManager
         return if (activityManager.deviceConfigurationInfo.reqGlEsVersion >= 0x30000) { 3 } else { 2 }
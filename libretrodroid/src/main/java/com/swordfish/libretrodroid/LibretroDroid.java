@@ -17,6 +17,7 @@
 
 package com.swordfish.libretrodroid;
 
+import java.nio.ByteBuffer;
 import java.util.List;
 
 public class LibretroDroid {
@@ -91,7 +92,8 @@ public class LibretroDroid {
         boolean enableMicrophone,
         boolean skipDuplicateFrames,
         ImmersiveMode immersiveMode,
-        String language
+        String language,
+        String cacheDir
     );
 
     public static native void loadGameFromPath(String gameFilePath);
@@ -111,7 +113,70 @@ public class LibretroDroid {
 
     public static native void setRumbleEnabled(boolean enabled);
     public static native void setFrameSpeed(int speed);
+
+    /**
+     * Present the frame the core would produce a few frames from now to hide input lag.
+     * @param frames Number of frames to run ahead, 0 disables run-ahead
+     * @param useSecondInstance Run ahead on a second core instance, avoids audio glitches on some cores.
+     *                          The instance is copied and loaded in the background, the main one is
+     *                          used meanwhile. Disabling it or unloading the game while it loads waits
+     *                          for the load to finish.
+     */
+    public static native void setRunAhead(int frames, boolean useSecondInstance);
+
+    /**
+     * @return True when the second run-ahead instance could not be created and run-ahead uses a single instance
+     */
+    public static native boolean isRunAheadSecondInstanceFailed();
+
+    /**
+     * Keep the states of the last frames and replay them only when the polled input changes.
+     * @param frames Number of frames to roll back, 0 disables preemptive frames
+     */
+    public static native void setPreemptiveFrames(int frames);
+
+    /**
+     * Preemptive frames counters: rollbacks, serialize count, serialize time (us),
+     * unserialize count, unserialize time (us).
+     */
+    public static native long[] getPreemptiveFramesStats();
     public static native void setAudioEnabled(boolean enabled);
+
+    public static final int AUDIO_RESAMPLER_LINEAR = 0;
+    public static final int AUDIO_RESAMPLER_POLYPHASE_SINC = 1;
+
+    /**
+     * Select how core audio is converted to the output rate.
+     * @param resampler AUDIO_RESAMPLER_LINEAR is the cheapest, AUDIO_RESAMPLER_POLYPHASE_SINC
+     *                  avoids aliasing and muffled highs at a higher CPU cost
+     */
+    public static native void setAudioResampler(int resampler);
+
+    /**
+     * Pace the emulation with the audio output instead of the display. Useful on screens whose
+     * refresh rate does not match the content, where it avoids both pitch adjustments and
+     * dropped frames. Ignored while audio or black frame insertion are disabled.
+     */
+    public static native void setAudioSync(boolean enabled);
+
+    /**
+     * Apply a RetroArch DSP filter chain to the core audio.
+     * @param configPath Path to a .dsp config using the builtin filters (eq, iir, echo, chorus,
+     *                   phaser, wahwah, panning), or null to disable it
+     */
+    public static native void setAudioDSP(String configPath);
+
+    public static final int FAST_FORWARD_AUDIO_PITCH = 0;
+    public static final int FAST_FORWARD_AUDIO_TIME_STRETCH = 1;
+    public static final int FAST_FORWARD_AUDIO_DROP = 2;
+
+    /**
+     * Select how audio plays while fast-forwarding.
+     * @param mode FAST_FORWARD_AUDIO_PITCH speeds up and pitches up the audio,
+     *             FAST_FORWARD_AUDIO_TIME_STRETCH keeps the original pitch,
+     *             FAST_FORWARD_AUDIO_DROP mutes it and saves the processing
+     */
+    public static native void setFastForwardAudio(int mode);
     public static native void setShaderConfig(GLRetroShader shader);
     public static native void setFilterMode(int mode);
     public static native void setIntegerScaling(boolean enabled);
@@ -120,6 +185,13 @@ public class LibretroDroid {
     public static native void setViewport(float x, float y, float width, float height);
 
     public static native byte[] serializeState();
+    public static native int getSerializeSize();
+
+    /**
+     * Serialize the state straight into a direct ByteBuffer, avoiding any intermediate copy.
+     * @return The state size, or -1 if the buffer is not direct, too small or serialization failed
+     */
+    public static native int serializeStateInto(ByteBuffer buffer);
     public static native boolean unserializeState(byte[] state);
 
     public static native void setCheat(int index, boolean enable, String code);
@@ -128,14 +200,44 @@ public class LibretroDroid {
     public static native byte[] serializeSRAM();
     public static native boolean unserializeSRAM(byte[] sram);
 
+    /**
+     * Start tracking save RAM changes. The save file is assumed to match the current save RAM.
+     * @param pageSize Granularity of the tracking in bytes, 0 picks a default
+     */
+    public static native void startSRAMMonitor(int pageSize);
+    public static native void stopSRAMMonitor();
+    public static native int[] getSRAMDirtyPages();
+
+    /**
+     * Write only the changed save RAM pages to the file at their offset.
+     * @param fd Save file descriptor, opened for writing without truncation
+     * @return Number of bytes written, or -1 on error
+     */
+    public static native long flushSRAM(int fd);
+
     public static final int MEMORY_SAVE_RAM = 0;
     public static final int MEMORY_RTC = 1;
     public static final int MEMORY_SYSTEM_RAM = 2;
     public static final int MEMORY_VIDEO_RAM = 3;
 
     public static native byte[] getMemoryData(int memoryType);
+
+    /**
+     * Copy a core memory region straight into a direct ByteBuffer.
+     * @return The region size, or -1 if it is unavailable or the buffer is not direct or too small
+     */
+    public static native int getMemoryDataInto(int memoryType, ByteBuffer buffer);
     public static native int getMemorySize(int memoryType);
 
+    /**
+     * Zero-copy, read-only view over a core memory region, null if the core does not expose it.
+     * The buffer aliases core memory: read it on the GL thread only, and not after
+     * getMemoryGeneration() changes. Unloading the game empties it.
+     */
+    public static native ByteBuffer getMemoryView(int memoryType);
+    public static native MemoryDescriptor[] getMemoryDescriptors();
+    public static native long getMemoryGeneration();
+
     public static native void updateVariable(Variable variable);
     public static native Variable[] getVariables();
 
@@ -155,13 +257,70 @@ public class LibretroDroid {
     public static native Controller[][] getControllers();
     public static native void setControllerType(int port, int type);
 
-    public static native void initRewindBuffer(int slotCount, int maxStateSize);
+    public static final int REWIND_MODE_FULL = 0;
+    public static final int REWIND_MODE_DELTA = 1;
+
+    public static final int REWIND_CODEC_NONE = 0;
+    public static final int REWIND_CODEC_FAST_LZ = 1;
+    public static final int REWIND_CODEC_DEFLATE = 2;
+
+    /**
+     * Allocate the native rewind buffer.
+     * @param slotCount Maximum number of states kept in REWIND_MODE_FULL. In REWIND_MODE_DELTA the
+     *                  budget bounds the history instead, up to 64 times this many states
+     * @param maxStateSize Largest expected serialized state size in bytes
+     * @param mode REWIND_MODE_FULL stores every state, REWIND_MODE_DELTA stores compact deltas
+     * @param budgetBytes Memory budget for stored states, 0 picks slotCount * maxStateSize.
+     *                    Negative values are rejected and the call is ignored
+     * @param codec REWIND_CODEC_FAST_LZ favours speed, REWIND_CODEC_DEFLATE favours ratio
+     */
+    public static native void initRewindBuffer(int slotCount, int maxStateSize, int mode, long budgetBytes, int codec);
     public static native boolean captureRewindState();
     public static native boolean rewindFrame();
     public static native void clearRewindBuffer();
     public static native void destroyRewindBuffer();
     public static native float getRewindBufferUsage();
     public static native int getRewindBufferValidCount();
+    public static native long getRewindBufferUsedBytes();
+    public static native long getRewindBufferCapacityBytes();
+
+    /**
+     * Move delta encoding and ring insertion of rewind captures to a worker thread. The
+     * emulation thread then only serializes into a pooled buffer.
+     */
+    public static native void setRewindCaptureAsync(boolean enabled);
+
+    /**
+     * Frame time histograms. Bucket i counts samples shorter than (125us << i), the last bucket
+     * counts everything longer.
+     */
+    public static native long[] getStepTimeHistogram();
+    public static native long[] getRewindCaptureTimeHistogram();
+    public static native void resetFrameTimeHistograms();
+
+    /**
+     * Audio pipeline counters, accumulated across games until reset: callbacks, underruns,
+     * underrun frames, overruns, overrun frames, xruns, requested callback frames, last, min, max
+     * and average callback frames, and the 5th, 50th and 95th percentiles of the buffer fill
+     * level (percent).
+     */
+    public static native long[] getAudioTelemetry();
+
+    /**
+     * Most recent rate controller samples, oldest first, as (error, proportional, integral)
+     * triplets. One sample is recorded per audio callback.
+     */
+    public static native float[] getAudioControllerTrace();
+    public static native void resetAudioTelemetry();
+
+    /**
+     * Software frame upload counters, accumulated across games until reset: uploads, uploads
+     * which went through a pixel buffer, waits on a pixel buffer fence and the total time spent
+     * waiting (nanoseconds), frames skipped because identical to the previous one, uploads of
+     * only the changed rows, total bytes uploaded and bytes uploaded for the last frame.
+     */
+    public static native long[] getVideoTelemetry();
+    public static native void resetVideoTelemetry();
 
     public static native void initAchievements(AchievementDef[] achievements, int consoleId);
     public static native void clearAchievements();
@@ -0,0 +1,54 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+package com.swordfish.libretrodroid;
+
+import java.nio.ByteBuffer;
+
+/**
+ * A region of the emulated address space as described by the core memory map.
+ * The view is a read-only buffer pointing straight into core memory. It must only be read on the
+ * GL thread and only while {@link LibretroDroid#getMemoryGeneration()} returns the generation it
+ * was obtained in. Unloading the game empties it.
+ */
+public class MemoryDescriptor {
+    public long flags;
+    public long start;
+    public long select;
+    public long disconnect;
+    public long length;
+    public String addressSpace;
+    public ByteBuffer view;
+
+    public MemoryDescriptor(
+        long flags,
+        long start,
+        long select,
+        long disconnect,
+        long length,
+        String addressSpace,
+        ByteBuffer view
+    ) {
+        this.flags = flags;
+        this.start = start;
+        this.select = select;
+        this.disconnect = disconnect;
+        this.length = length;
+        this.addressSpace = addressSpace;
+        this.view = view;
+    }
+}
@@ -0,0 +1,36 @@
+/*
+ *     Copyright (C) 2024  Argosy Contributors
+ *
+ *     This program is free software: you can redistribute it and/or modify
+ *     it under the terms of the GNU General Public License as published by
+ *     the Free Software Foundation, either version 3 of the License, or
+ *     (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public License
+ *     along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+package com.swordfish.libretrodroid
+
+import java.nio.ByteBuffer
+
+/**
+ * Zero-copy, read-only view over a core memory region. The buffer aliases core memory, which the
+ * core updates every frame, so it must only be read on the GL thread and only while [isValid]
+ * holds, that is until the memory generation changes (the game was unloaded or replaced).
+ *
+ * Unloading empties the buffer, so a stale read throws instead of touching freed memory. Copies
+ * made with duplicate() or slice() are not emptied and follow the same rules.
+ */
+class MemoryView internal constructor(
+    val buffer: ByteBuffer,
+    private val generation: Long
+) {
+    val isValid: Boolean
+        get() = LibretroDroid.getMemoryGeneration() == generation
+}